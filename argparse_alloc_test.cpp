@@ -0,0 +1,318 @@
+/*
+ * Allocation budget tests
+ *
+ * Replaces the global operator new/delete to count the heap allocations made by
+ * standard scenarios (defining a parser, parsing, and printing the help), and fails
+ * if any scenario exceeds its budget. Budgets are deliberately tight, so an
+ * unintended per-token (or per-argument) allocation shows up as a regression.
+ *
+ * The peak number of bytes in use is also tracked, to check that streaming a long
+ * command-line does not hold it in memory.
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "argparse.hpp"
+
+using argparse::ArgValue;
+
+struct AllocCounts {
+    size_t allocs = 0;
+    size_t bytes = 0;
+    long peak_bytes = 0; //Most bytes in use (above those in use when counting started)
+};
+
+//Precedes each allocation, recording its size so the bytes in use can be tracked
+union AllocHeader {
+    size_t size;
+    std::max_align_t align;
+};
+
+static bool counting = false;
+static AllocCounts counts;
+static long bytes_in_use = 0;
+static long counting_start_bytes = 0;
+
+static void* counted_alloc(size_t size, bool nothrow);
+static void counted_free(void* ptr);
+static void start_counting();
+
+void* operator new(size_t size) { return counted_alloc(size, false); }
+void* operator new[](size_t size) { return counted_alloc(size, false); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, true); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, true); }
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_free(ptr); }
+
+static void* counted_alloc(size_t size, bool nothrow) {
+    auto header = static_cast<AllocHeader*>(std::malloc(sizeof(AllocHeader) + size));
+    if (!header) {
+        if (nothrow) return nullptr;
+        throw std::bad_alloc();
+    }
+    header->size = size;
+
+    bytes_in_use += long(size);
+    if (counting) {
+        ++counts.allocs;
+        counts.bytes += size;
+        counts.peak_bytes = std::max(counts.peak_bytes, bytes_in_use - counting_start_bytes);
+    }
+    return header + 1;
+}
+
+static void counted_free(void* ptr) {
+    if (!ptr) return;
+    auto header = static_cast<AllocHeader*>(ptr) - 1;
+    bytes_in_use -= long(header->size);
+    std::free(header);
+}
+
+static void start_counting() {
+    counts = AllocCounts();
+    counting_start_bytes = bytes_in_use;
+    counting = true;
+}
+
+//The most allocations (and bytes) a scenario may make.
+//Set ~15% above the measured values (with libstdc++), to allow for other standard libraries
+struct AllocBudget {
+    const char* scenario;
+    size_t allocs;
+    size_t bytes;
+};
+
+static const AllocBudget BUDGETS[] = {
+    {"construction",       190,  21000},
+    {"parse_defaults",      40,   2000},
+    {"help",               230,  31000},
+};
+
+struct Args {
+    ArgValue<std::string> circuit;
+    ArgValue<bool> verbose;
+    ArgValue<bool> timing_analysis;
+    ArgValue<size_t> seed;
+    ArgValue<float> inner_num;
+    ArgValue<float> init_t;
+    ArgValue<std::string> place_algorithm;
+    ArgValue<int> max_router_iterations;
+    ArgValue<float> pres_fac_mult;
+    ArgValue<std::string> router_algorithm;
+    ArgValue<std::vector<int>> values;
+};
+
+static void define_parser(argparse::ArgumentParser& parser, Args& args);
+static int check_budget(const char* scenario, const AllocCounts& measured);
+static AllocCounts parse_nargs_counts(argparse::ArgumentParser& parser, size_t num_values);
+static int check_nargs_growth(argparse::ArgumentParser& parser, size_t num_values);
+#ifndef _WIN32
+static long stream_peak_bytes(size_t num_tokens);
+static int check_stream_growth(size_t num_tokens);
+#endif
+
+static void define_parser(argparse::ArgumentParser& parser, Args& args) {
+    parser.add_argument(args.circuit, "circuit")
+            .help("Circuit file");
+    parser.add_argument(args.verbose, "--verbose", "-v")
+            .help("Enables verbose output")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false");
+    parser.add_argument(args.timing_analysis, "--timing_analysis")
+            .help("Controls whether timing analysis is performed")
+            .default_value("true");
+    parser.add_argument(args.values, "--values")
+            .help("Values to process")
+            .nargs('*');
+
+    auto& place_grp = parser.add_argument_group("placement options");
+    place_grp.add_argument(args.seed, "--seed")
+            .help("Placement random number generator seed")
+            .default_value("1");
+    place_grp.add_argument(args.inner_num, "--inner_num")
+            .help("Controls the number of moves per temperature")
+            .default_value("1.0");
+    place_grp.add_argument(args.init_t, "--init_t")
+            .help("Initial temperature for manual annealing schedule")
+            .default_value("100.0");
+    place_grp.add_argument(args.place_algorithm, "--place_algorithm")
+            .help("Controls which placement algorithm is used")
+            .default_value("path_timing_driven")
+            .choices({"bounding_box", "path_timing_driven"});
+
+    auto& route_grp = parser.add_argument_group("routing options");
+    route_grp.add_argument(args.max_router_iterations, "--max_router_iterations")
+            .help("Maximum number of Pathfinder-based routing iterations")
+            .default_value("50");
+    route_grp.add_argument(args.pres_fac_mult, "--pres_fac_mult")
+            .help("Sets how quickly the present overuse penalty increases")
+            .default_value("1.3");
+    route_grp.add_argument(args.router_algorithm, "--router_algorithm")
+            .help("Specifies the router algorithm to use")
+            .default_value("timing_driven")
+            .choices({"breadth_first", "timing_driven"});
+}
+
+static int check_budget(const char* scenario, const AllocCounts& measured) {
+    for (const auto& budget : BUDGETS) {
+        if (std::string(budget.scenario) != scenario) continue;
+
+        bool over = measured.allocs > budget.allocs || measured.bytes > budget.bytes;
+        std::cout << (over ? "[FAIL] " : "[PASS] ") << std::left << std::setw(18) << scenario
+                  << " allocs " << std::right << std::setw(6) << measured.allocs << " / " << std::setw(6) << budget.allocs
+                  << "  bytes " << std::setw(8) << measured.bytes << " / " << std::setw(8) << budget.bytes << std::endl;
+        if (over) {
+            std::cout << "       expected: allocs <= " << budget.allocs << ", bytes <= " << budget.bytes << std::endl;
+            std::cout << "       measured: allocs  = " << measured.allocs << " (" << std::showpos
+                      << long(measured.allocs) - long(budget.allocs) << "), bytes  = " << std::noshowpos << measured.bytes
+                      << " (" << std::showpos << long(measured.bytes) - long(budget.bytes) << ")" << std::noshowpos << std::endl;
+        }
+        return over ? 1 : 0;
+    }
+    std::cout << "[FAIL] No budget for scenario " << scenario << std::endl;
+    return 1;
+}
+
+//Returns the allocations made parsing num_values values (each longer than the SSO buffer) of a '*' option.
+//The command-line is built (and moved into its token source) before counting
+static AllocCounts parse_nargs_counts(argparse::ArgumentParser& parser, size_t num_values) {
+    std::vector<std::string> cmd_line = {"top.blif", "--values"};
+    for (size_t i = 0; i < num_values; ++i) {
+        std::string value = std::to_string(i);
+        value.insert(0, 32 - value.size(), '0');
+        cmd_line.push_back(value);
+    }
+    argparse::VectorTokenSource tokens(std::move(cmd_line));
+    parser.reset_destinations();
+
+    start_counting();
+    parser.parse_args_throw(tokens);
+    counting = false;
+    return counts;
+}
+
+//Parsing twice as many values must only add a bounded number of allocations (the destination's growth),
+//and no more bytes per value than the destination stores
+static int check_nargs_growth(argparse::ArgumentParser& parser, size_t num_values) {
+    const long max_extra_allocs = 4;
+    const long max_extra_bytes_per_value = 16;
+
+    AllocCounts measured = parse_nargs_counts(parser, num_values);
+    AllocCounts measured_2x = parse_nargs_counts(parser, 2 * num_values);
+    long extra_allocs = long(measured_2x.allocs) - long(measured.allocs);
+    long extra_bytes = long(measured_2x.bytes) - long(measured.bytes);
+
+    bool over = extra_allocs > max_extra_allocs || extra_bytes > max_extra_bytes_per_value * long(num_values);
+    std::cout << (over ? "[FAIL] " : "[PASS] ") << std::left << std::setw(18) << "parse_long_nargs"
+              << " allocs " << std::right << std::setw(6) << measured.allocs << " -> " << std::setw(6) << measured_2x.allocs
+              << " (+" << extra_allocs << " / " << max_extra_allocs << ")"
+              << "  bytes " << std::setw(8) << measured.bytes << " -> " << std::setw(8) << measured_2x.bytes
+              << " (+" << extra_bytes << " / " << max_extra_bytes_per_value * long(num_values) << ")" << std::endl;
+    return over ? 1 : 0;
+}
+
+#ifndef _WIN32
+//Returns the peak bytes in use while streaming num_tokens values (each longer than
+//the SSO buffer) from a file descriptor into a '*' positional
+static long stream_peak_bytes(size_t num_tokens) {
+    char path[] = "/tmp/argparse_alloc_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return -1;
+
+    std::string token;
+    for (size_t i = 0; i < num_tokens; ++i) {
+        token = std::to_string(i);
+        token.insert(0, 24 - token.size(), '0');
+        token.push_back('\0');
+        if (write(fd, token.data(), token.size()) != ssize_t(token.size())) {
+            close(fd);
+            unlink(path);
+            return -1;
+        }
+    }
+    lseek(fd, 0, SEEK_SET);
+
+    std::stringstream os;
+    ArgValue<std::vector<int>> values;
+    auto parser = argparse::ArgumentParser("stream", "Streaming test parser", os);
+    parser.add_argument(values, "values")
+            .nargs('*');
+    argparse::FdTokenSource tokens(fd);
+
+    start_counting();
+    parser.parse_args_throw(tokens);
+    counting = false;
+
+    close(fd);
+    unlink(path);
+    return counts.peak_bytes;
+}
+
+//Streaming twice as many tokens must only grow the peak memory by the destination
+//(not by the command-line, which is not recorded)
+static int check_stream_growth(size_t num_tokens) {
+    const long max_bytes_per_token = 24;
+
+    long peak = stream_peak_bytes(num_tokens);
+    long peak_2x = stream_peak_bytes(2 * num_tokens);
+    long limit = peak + max_bytes_per_token * long(num_tokens);
+
+    bool over = peak < 0 || peak_2x < 0 || peak_2x > limit;
+    std::cout << (over ? "[FAIL] " : "[PASS] ") << std::left << std::setw(18) << "stream_fd"
+              << " peak bytes " << std::right << std::setw(8) << peak << " (" << num_tokens << " tokens), "
+              << std::setw(8) << peak_2x << " (" << 2 * num_tokens << " tokens) / " << limit << std::endl;
+    return over ? 1 : 0;
+}
+#endif
+
+int main(int /*argc*/, const char** argv) {
+    int num_failed = 0;
+
+    Args args;
+    std::stringstream help;
+
+    //Defining the parser
+    start_counting();
+    auto parser = argparse::ArgumentParser(argv[0], "Allocation budget test parser", help);
+    define_parser(parser, args);
+    counting = false;
+    num_failed += check_budget("construction", counts);
+
+    //Parsing (the command-lines are built before counting)
+    parser.parse_args_throw({"warm_up.blif"}); //Builds the help option and constraint tables
+
+    std::vector<std::string> defaults_cmd_line = {"top.blif"};
+    parser.reset_destinations();
+    start_counting();
+    parser.parse_args_throw(defaults_cmd_line);
+    counting = false;
+    num_failed += check_budget("parse_defaults", counts);
+
+    num_failed += check_nargs_growth(parser, 1000);
+
+    //Help rendering
+    start_counting();
+    parser.print_help();
+    counting = false;
+    num_failed += check_budget("help", counts);
+
+#ifndef _WIN32
+    //Streaming a long command-line from a file descriptor
+    num_failed += check_stream_growth(10000);
+#endif
+
+    if (num_failed != 0) {
+        std::cout << "FAILED: " << num_failed << " scenario(s) over budget!" << std::endl;
+    }
+    return num_failed;
+}
@@ -1,6 +1,14 @@
 #include "argparse.hpp"
 #include "argparse_util.hpp"
 
+#include <future>
+#include <thread>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
 using argparse::ArgValue;
 using argparse::ConvertedValue;
 
@@ -93,6 +101,11 @@ struct Args {
 
 bool expect_pass(argparse::ArgumentParser& parser, std::vector<std::string> cmd_line);
 bool expect_fail(argparse::ArgumentParser& parser, std::vector<std::string> cmd_line);
+bool expect_fail_message(argparse::ArgumentParser& parser, std::vector<std::string> cmd_line, std::string expected_msg);
+#ifndef _WIN32
+std::string make_temp_dir();
+void remove_temp_dir(const std::string& dir);
+#endif
 
 struct OnOff {
     ConvertedValue<bool> from_str(std::string str) {
@@ -116,6 +129,45 @@ struct OnOff {
     }
 };
 
+//Default integer conversion, counting the number of conversions (in each direction)
+struct CountedInt {
+    static int num_conversions;
+    static int num_to_strs;
+
+    ConvertedValue<int> from_str(std::string str) {
+        ++num_conversions;
+        return argparse::DefaultConverter<int>().from_str(str);
+    }
+
+    ConvertedValue<std::string> to_str(int val) {
+        ++num_to_strs;
+        return argparse::DefaultConverter<int>().to_str(val);
+    }
+
+    std::vector<std::string> default_choices() {
+        return {};
+    }
+};
+int CountedInt::num_conversions = 0;
+int CountedInt::num_to_strs = 0;
+
+//Integer conversion deferred to the parser's conversion threads
+struct AsyncInt {
+    std::future<ConvertedValue<int>> from_str(std::string str) {
+        return std::async(std::launch::deferred, [str] {
+            return argparse::DefaultConverter<int>().from_str(str);
+        });
+    }
+
+    ConvertedValue<std::string> to_str(int val) {
+        return argparse::DefaultConverter<int>().to_str(val);
+    }
+
+    std::vector<std::string> default_choices() {
+        return {};
+    }
+};
+
 int main(
         int 
 #ifndef TEST
@@ -514,6 +566,208 @@ int main(
         }
     }
 
+    //The argument which set a value is looked up through the parser
+    static_assert(sizeof(ArgValue<bool>) <= 4, "ArgValue<bool> should be compact");
+    parser.parse_args_throw(std::vector<std::string>{"my_arch1.xml", "my_circuit1.blif", "--analysis", "-j", "3"});
+    if (parser.argument_name(args.num_workers) != "--num_workers/-j"
+        || parser.argument_group(args.num_workers) != "general options"
+        || parser.argument_name(args.bend_cost) != "") {
+        std::cout << "[FAIL] Unexpected argument name/group for value" << std::endl;
+        ++num_failed;
+    }
+    parser.reset_destinations();
+
+    //Incremental re-parse matches a full re-parse
+    auto describe_args = [&]() {
+        std::stringstream ss;
+        ss << args.circuit.value() << " " << int(args.circuit.provenance()) << ";";
+        ss << args.num_workers.value() << " " << int(args.num_workers.provenance()) << ";";
+        ss << args.route.value() << " " << int(args.route.provenance()) << ";";
+        ss << args.timing_analysis.value() << " " << int(args.timing_analysis.provenance()) << ";";
+        ss << argparse::join(args.one_or_more.value(), ",") << " " << int(args.one_or_more.provenance()) << ";";
+        return ss.str();
+    };
+    std::vector<std::vector<std::string>> reparse_cases = {
+        {"my_arch1.xml", "my_circuit1.blif", "--analysis", "-j", "3"},
+        {"my_arch1.xml", "my_circuit1.blif", "--analysis", "-j", "4"}, //Changed value
+        {"my_arch1.xml", "my_circuit1.blif", "--analysis", "-j4"}, //Same value, attached to its short option
+        {"my_arch1.xml", "my_circuit1.blif", "--analysis", "-j5"}, //Changed attached value
+        {"my_arch1.xml", "my_circuit1.blif", "--analysis", "-j", "4"},
+        {"my_arch1.xml", "my_circuit2.blif", "--analysis", "-j", "4", "--timing_analysis", "off"}, //Changed positional, added option
+        {"my_arch1.xml", "my_circuit2.blif", "--analysis", "--timing_analysis", "off"}, //Removed option
+        {"my_arch1.xml", "my_circuit2.blif", "--route", "--analysis", "--one_or_more", "1", "2"}, //Shared destination
+        {"my_arch1.xml", "my_circuit2.blif", "--analysis", "--one_or_more", "2"},
+    };
+    parser.record_parse_state(true);
+    parser.parse_args_throw(reparse_cases[0]);
+    for (size_t i = 1; i < reparse_cases.size(); ++i) {
+        parser.reparse_args_throw(parser.parse_state(), reparse_cases[i]);
+        auto incremental = describe_args();
+
+        parser.reset_destinations();
+        parser.parse_args_throw(reparse_cases[i]);
+        auto full = describe_args();
+
+        if (incremental != full) {
+            std::cout << "[FAIL] Incremental re-parse of '" << argparse::join(reparse_cases[i], " ") << "' gave '" << incremental << "' expected '" << full << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+    parser.reset_destinations();
+
+    //Restoring a snapshot returns to the baseline values
+    parser.parse_args_throw(reparse_cases[0]);
+    auto baseline = parser.snapshot();
+    auto baseline_args = describe_args();
+    for (size_t i = 1; i < reparse_cases.size(); ++i) {
+        parser.reparse_args_throw(parser.parse_state(), reparse_cases[i]);
+        parser.restore(baseline);
+        if (describe_args() != baseline_args) {
+            std::cout << "[FAIL] Restored snapshot gave '" << describe_args() << "' expected '" << baseline_args << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+    parser.reset_destinations();
+
+    //The serialized command-line reproduces the specified values
+    std::vector<std::string> serialize_cmd_line = {"--one_or_more", "1.5", "0.1", "my_arch1.xml", "--analysis", "--timing_analysis", "off", "-j3", "my_circuit1.blif"};
+    parser.parse_args_throw(serialize_cmd_line);
+    auto specified_args = describe_args();
+    auto serialized = parser.serialize_args("vpr");
+    auto serialized_args = serialized.args();
+    std::vector<std::string> expected_serialized = {"vpr", "my_arch1.xml", "my_circuit1.blif", "--analysis", "--timing_analysis", "off", "--num_workers", "3", "--one_or_more", "1.5", "0.100000001"};
+    parser.reset_destinations();
+    parser.parse_args_throw(std::vector<std::string>(serialized_args.begin() + 1, serialized_args.end()));
+    if (serialized_args != expected_serialized
+        || describe_args() != specified_args
+        || serialized.argv()[serialized.size()] != nullptr) {
+        std::cout << "[FAIL] Unexpected serialized command-line '" << argparse::join(serialized_args, " ") << "'" << std::endl;
+        ++num_failed;
+    }
+    parser.reset_destinations();
+
+#ifndef _WIN32
+    //Arguments can be streamed from a file descriptor (through a buffer smaller than the arguments)
+    std::vector<std::pair<char,std::string>> fd_cases = {
+        {'\0', std::string("my_arch1.xml\0my_circuit1.blif\0--analysis\0-j\0003\0", 46)},
+        {'\n', "my_arch1.xml\nmy_circuit1.blif\n--analysis\n-j\n3"}, //No final delimiter
+    };
+    for (const auto& fd_case : fd_cases) {
+        int fds[2];
+        if (pipe(fds) != 0
+            || write(fds[1], fd_case.second.data(), fd_case.second.size()) != ssize_t(fd_case.second.size())) {
+            std::cout << "[FAIL] Could not create pipe" << std::endl;
+            ++num_failed;
+            continue;
+        }
+        close(fds[1]);
+
+        argparse::FdTokenSource fd_tokens(fds[0], fd_case.first, 4);
+        parser.parse_args_throw(fd_tokens);
+        close(fds[0]);
+        if (parser.parse_state().args() != std::vector<std::string>({"my_arch1.xml", "my_circuit1.blif", "--analysis", "-j", "3"})
+            || args.circuit.value() != "my_circuit1.blif"
+            || args.num_workers != 3u) {
+            std::cout << "[FAIL] Unexpected arguments read from file descriptor: '" << argparse::join(parser.parse_state().args(), " ") << "'" << std::endl;
+            ++num_failed;
+        }
+        parser.reset_destinations();
+    }
+#endif
+
+    //Parse statistics are only collected when requested
+    parser.parse_stats_flag("--dump-parse-stats");
+    parser.parse_args_throw(std::vector<std::string>{"my_arch1.xml", "my_circuit1.blif", "--analysis", "--dump-parse-stats", "-j", "3", "--slack_definition", "I"});
+    const argparse::ParseStats* stats = parser.parse_stats();
+    if (!stats
+        || stats->num_tokens != 7
+        || stats->argument_conversions[args.num_workers.argument_id()] != 3 //Default, lookahead check and specified value
+        || stats->argument_conversion[args.num_workers.argument_id()].count() == 0
+        || stats->choice_validation.count() == 0 //Value following its option
+        || stats->allocations_counted) {
+        std::cout << "[FAIL] Unexpected parse statistics" << std::endl;
+        ++num_failed;
+    }
+    parser.reset_destinations();
+    parser.parse_args_throw(std::vector<std::string>{"my_arch1.xml", "my_circuit1.blif", "--analysis"});
+    if (parser.parse_stats()) {
+        std::cout << "[FAIL] Parse statistics collected when not requested" << std::endl;
+        ++num_failed;
+    }
+    parser.parse_stats_flag("");
+    parser.reset_destinations();
+
+#ifndef _WIN32
+    //Repeated command-lines are restored from the parse cache, without converting values
+    struct CacheArgs {
+        ArgValue<int> effort;
+        ArgValue<std::vector<int>> sizes;
+        ArgValue<std::string> name;
+    } cache_args;
+    auto cache_parser = argparse::ArgumentParser(argv[0], "Test cached parser");
+    std::string cache_dir = make_temp_dir();
+    cache_parser.parse_cache_dir(cache_dir);
+    cache_parser.add_argument<int,CountedInt>(cache_args.effort, "--effort")
+            .default_value("1");
+    cache_parser.add_argument<int,CountedInt>(cache_args.sizes, "--sizes")
+            .nargs('+');
+    cache_parser.add_argument(cache_args.name, "name");
+    std::vector<std::string> cache_cmd_line = {"--sizes", "3", "4", "circuit"};
+    cache_parser.parse_args_throw(cache_cmd_line);
+    cache_parser.reset_destinations();
+    cache_parser.parse_args_throw({"--sizes", "5", "other_circuit"});
+    cache_parser.reset_destinations();
+    CountedInt::num_conversions = 0;
+    cache_parser.parse_args_throw(cache_cmd_line);
+    if (CountedInt::num_conversions != 0
+        || cache_args.effort != 1
+        || cache_args.effort.provenance() != argparse::Provenance::DEFAULT
+        || cache_args.sizes.value() != std::vector<int>({3, 4})
+        || cache_args.name.value() != "circuit"
+        || cache_parser.argument_name(cache_args.sizes) != "--sizes"
+        || cache_parser.parse_state().args() != cache_cmd_line) {
+        std::cout << "[FAIL] Unexpected values restored from parse cache" << std::endl;
+        ++num_failed;
+    }
+    cache_parser.reparse_args_throw(cache_parser.parse_state(), {"--effort", "2", "circuit"});
+    if (cache_args.effort != 2 || !cache_args.sizes.value().empty() || cache_args.name.value() != "circuit") {
+        std::cout << "[FAIL] Unexpected values re-parsed after a cached parse" << std::endl;
+        ++num_failed;
+    }
+    remove_temp_dir(cache_dir);
+#endif
+
+    //Memoized arguments convert each distinct value once, remembering both values and errors
+    struct MemoArgs {
+        ArgValue<int> effort;
+        ArgValue<std::vector<int>> sizes;
+    } memo_args;
+    auto memo_parser = argparse::ArgumentParser(argv[0], "Test memoized parser");
+    memo_parser.add_argument<int,CountedInt>(memo_args.effort, "--effort")
+            .memoize(4);
+    auto& memo_sizes_arg = memo_parser.add_argument<int,CountedInt>(memo_args.sizes, "--sizes")
+            .nargs('+')
+            .memoize(2);
+    CountedInt::num_conversions = 0;
+    for (int i = 0; i < 3; ++i) {
+        memo_parser.parse_args_throw(std::vector<std::string>{"--effort", "5", "--sizes", "3", "3", "4"});
+        memo_parser.reset_destinations();
+    }
+    bool memo_errors_pass = true;
+    for (int i = 0; i < 2; ++i) {
+        memo_errors_pass &= expect_fail_message(memo_parser, {"--effort", "x"}, "Missing expected argument for --effort");
+    }
+    argparse::MemoStats sizes_memo_stats = memo_sizes_arg.memo_stats();
+    if (!memo_errors_pass
+        || CountedInt::num_conversions != 4
+        || sizes_memo_stats.misses != 2
+        || sizes_memo_stats.hits == 0
+        || sizes_memo_stats.size != 2) {
+        std::cout << "[FAIL] Unexpected memoized conversions (" << CountedInt::num_conversions << " conversions, "
+                  << sizes_memo_stats.hits << " hits, " << sizes_memo_stats.misses << " misses)" << std::endl;
+        ++num_failed;
+    }
+
     std::vector<std::vector<std::string>> fail_cases = {
         {"--analysis"}, //Missing positional
         {"my_arch7.xml", "--analysis"}, //Missing positional
@@ -540,6 +794,739 @@ int main(
         }
     }
 
+    std::vector<std::pair<std::vector<std::string>,std::string>> suggestion_cases = {
+        {{"my_arch1.xml", "my_circuit1.blif", "--analysis", "--rout_chan_width", "300"}, "did you mean '--route_chan_width'"}, //Misspelled option
+        {{"my_arch1.xml", "my_circuit1.blif", "--analysis", "--seeed", "3"}, "did you mean '--seed'"}, //Misspelled option
+        {{"my_arch1.xml", "my_circuit1.blif", "--analysis", "--router_algorithm", "timing_drivn"}, "did you mean 'timing_driven'"}, //Misspelled choice
+        {{"my_arch1.xml", "my_circuit1.blif", "--analysis", "--routing_failure_predictor", "agressive"}, "did you mean 'aggressive'"}, //Misspelled choice
+    };
+
+    for(const auto& suggestion_case : suggestion_cases) {
+        bool pass = expect_fail_message(parser, suggestion_case.first, suggestion_case.second);
+
+        if(!pass) {
+            std::cout << "       Expected failure with '" << suggestion_case.second << "': '" << argparse::join(suggestion_case.first, " ") << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+
+    //A saved schema accepts (and rejects, with the same message) the same command-lines as the parser
+    std::string schema_json = parser.schema().to_json();
+    argparse::ParserSchema schema = argparse::ParserSchema::from_json(schema_json);
+    if (schema.to_json() != schema_json) {
+        std::cout << "[FAIL] Parser schema changed by JSON round-trip" << std::endl;
+        ++num_failed;
+    }
+    for (const auto& cmd_line : pass_cases) {
+        try {
+            schema.validate(cmd_line);
+        } catch (const argparse::ArgParseError& err) {
+            std::cout << "[FAIL] Schema rejected '" << argparse::join(cmd_line, " ") << "': " << err.what() << std::endl;
+            ++num_failed;
+        }
+    }
+    for (const auto& cmd_line : fail_cases) {
+        std::string parser_error;
+        try {
+            parser.parse_args_throw(cmd_line);
+        } catch (const argparse::ArgParseError& err) {
+            parser_error = err.what();
+        }
+        parser.reset_destinations();
+
+        std::string schema_error;
+        try {
+            schema.validate(cmd_line);
+        } catch (const argparse::ArgParseError& err) {
+            schema_error = err.what();
+        }
+        if (schema_error.empty() || schema_error != parser_error) {
+            std::cout << "[FAIL] Schema error '" << schema_error << "' differs from parser error '" << parser_error << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+    try {
+        argparse::ParserSchema::from_json("{\"version\":99}");
+        std::cout << "[FAIL] Loaded parser schema of unsupported version" << std::endl;
+        ++num_failed;
+    } catch (const argparse::ArgParseError&) {
+    }
+
+    //Short flags may be combined, with the last taking a value
+    struct ClusterArgs {
+        ArgValue<bool> all;
+        ArgValue<bool> verbose;
+        ArgValue<int> jobs;
+    } cluster_args;
+    auto cluster_parser = argparse::ArgumentParser(argv[0], "Test short option cluster parser");
+    cluster_parser.add_argument(cluster_args.all, "--all", "-a")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false");
+    cluster_parser.add_argument(cluster_args.verbose, "--verbose", "-v")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false");
+    cluster_parser.add_argument(cluster_args.jobs, "--jobs", "-j")
+            .default_value("1");
+    std::vector<std::pair<std::vector<std::string>,int>> cluster_cases = {
+        {{"-av"}, 1},
+        {{"-avj4"}, 4},
+        {{"-vaj", "3"}, 3},
+    };
+    for (const auto& cluster_case : cluster_cases) {
+        cluster_parser.parse_args_throw(cluster_case.first);
+        if (!cluster_args.all || !cluster_args.verbose || cluster_args.jobs != cluster_case.second) {
+            std::cout << "[FAIL] Unexpected values from short option cluster '" << argparse::join(cluster_case.first, " ") << "'" << std::endl;
+            ++num_failed;
+        }
+        cluster_parser.reset_destinations();
+    }
+    argparse::ParserSchema cluster_schema = cluster_parser.schema();
+    std::vector<std::pair<std::vector<std::string>,std::string>> cluster_fail_cases = {
+        {{"-avx"}, "Unexpected short option '-x' in '-avx'"},
+        {{"-aj"}, "Missing expected argument for -j"},
+        {{"-ajx"}, "Invalid conversion from 'x' to integer for --jobs/-j"},
+    };
+    for (const auto& cluster_fail_case : cluster_fail_cases) {
+        for (int use_schema = 0; use_schema < 2; ++use_schema) {
+            try {
+                if (use_schema) {
+                    cluster_schema.validate(cluster_fail_case.first);
+                } else {
+                    cluster_parser.parse_args_throw(cluster_fail_case.first);
+                }
+                std::cout << "[FAIL] Accepted short option cluster '" << argparse::join(cluster_fail_case.first, " ") << "'" << std::endl;
+                ++num_failed;
+            } catch (const argparse::ArgParseError& err) {
+                if (err.what() != cluster_fail_case.second) {
+                    std::cout << "[FAIL] Unexpected short option cluster error '" << err.what() << "' expected '" << cluster_fail_case.second << "'" << std::endl;
+                    ++num_failed;
+                }
+            }
+        }
+        cluster_parser.reset_destinations();
+    }
+
+    //Option relationship constraints
+    struct ConstraintArgs {
+        ArgValue<bool> ascii;
+        ArgValue<bool> binary;
+        ArgValue<std::string> output;
+        ArgValue<std::string> compress;
+        ArgValue<std::string> netlist;
+        ArgValue<std::string> blif;
+    } constraint_args;
+    auto constraint_parser = argparse::ArgumentParser(argv[0], "Test constraint parser");
+    auto& format_grp = constraint_parser.add_argument_group("format options");
+    format_grp.add_argument(constraint_args.ascii, "--ascii")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false");
+    format_grp.add_argument(constraint_args.binary, "--binary")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false");
+    format_grp.mutually_exclusive();
+    constraint_parser.add_argument(constraint_args.output, "--output", "-o");
+    constraint_parser.add_argument(constraint_args.compress, "--compress");
+    constraint_parser.add_argument(constraint_args.netlist, "--netlist");
+    constraint_parser.add_argument(constraint_args.blif, "--blif");
+    constraint_parser.requires_arguments("--compress", {"-o"});
+    constraint_parser.at_least_one_of({"--netlist", "--blif"});
+
+    std::vector<std::vector<std::string>> constraint_pass_cases = {
+        {"--netlist", "a.net"},
+        {"--ascii", "--blif", "a.blif"},
+        {"--binary", "--compress", "gzip", "-o", "out", "--netlist", "a.net", "--blif", "a.blif"},
+    };
+    for(const auto& cmd_line : constraint_pass_cases) {
+        if(!expect_pass(constraint_parser, cmd_line)) {
+            std::cout << "       Failed to parse: '" << argparse::join(cmd_line, " ") << "'" << std::endl;
+            ++num_failed;
+        }
+        constraint_parser.reset_destinations();
+    }
+    std::vector<std::pair<std::vector<std::string>,std::string>> constraint_fail_cases = {
+        {{"--ascii", "--binary", "--netlist", "a.net"}, "Mutually exclusive arguments specified: --ascii, --binary"},
+        {{"--compress", "gzip", "--blif", "a.blif"}, "Argument --compress requires: --output/-o"},
+        {{"--ascii"}, "Expected at least one of: --netlist, --blif"},
+        {{"--ascii", "--binary", "--compress", "gzip"}, "Mutually exclusive arguments specified: --ascii, --binary; "
+                                                        "Argument --compress requires: --output/-o; "
+                                                        "Expected at least one of: --netlist, --blif"},
+    };
+    for(const auto& constraint_fail_case : constraint_fail_cases) {
+        if(!expect_fail_message(constraint_parser, constraint_fail_case.first, constraint_fail_case.second)) {
+            ++num_failed;
+        }
+        constraint_parser.reset_destinations();
+    }
+    try {
+        constraint_parser.mutually_exclusive({"--netlist", "--unknown"}); //Reported when declared, not when parsing
+        std::cout << "[FAIL] Declared a constraint on an unknown argument" << std::endl;
+        ++num_failed;
+    } catch (const argparse::ArgParseError& err) {
+        if (err.what() != std::string("Unknown argument '--unknown' in constraint")) {
+            std::cout << "[FAIL] Unexpected constraint error '" << err.what() << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+    if(!expect_pass(constraint_parser, {"--netlist", "a.net"})) { //The rejected constraint was not recorded
+        ++num_failed;
+    }
+    constraint_parser.reset_destinations();
+
+    //Bulk registration from argument specifications
+    struct BulkArgs {
+        ArgValue<std::string> circuit;
+        ArgValue<bool> verbose;
+        ArgValue<int> seed;
+        ArgValue<std::vector<double>> weights;
+        ArgValue<bool> timing;
+    } chained_args, bulk_args;
+    auto chained_parser = argparse::ArgumentParser(argv[0], "Test bulk registration parser");
+    chained_parser.add_argument(chained_args.circuit, "circuit")
+            .help("Circuit file");
+    chained_parser.add_argument(chained_args.verbose, "--verbose", "-v")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false");
+    chained_parser.add_argument(chained_args.seed, "--seed")
+            .default_value("1")
+            .choices({"1", "2", "3"})
+            .metavar("N")
+            .required(true);
+    chained_parser.add_argument(chained_args.weights, "--weights")
+            .nargs('+')
+            .delimiter(',')
+            .default_value({"0.5", "1"});
+    chained_parser.add_argument_group("analysis options")
+            .add_argument<bool,OnOff>(chained_args.timing, "--timing")
+            .show_in(argparse::ShowIn::HELP_ONLY)
+            .default_value("on");
+
+    auto bulk_parser = argparse::ArgumentParser(argv[0], "Test bulk registration parser");
+    bulk_parser.add_arguments({
+        argparse::argument_spec(bulk_args.circuit, "circuit")
+            .help("Circuit file"),
+        argparse::argument_spec(bulk_args.verbose, "--verbose", "-v")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false"),
+        argparse::argument_spec(bulk_args.seed, "--seed")
+            .default_value("1")
+            .choices({"1", "2", "3"})
+            .metavar("N")
+            .required(true),
+        argparse::argument_spec(bulk_args.weights, "--weights")
+            .nargs('+')
+            .delimiter(',')
+            .default_value(std::vector<std::string>{"0.5", "1"}),
+    });
+    bulk_parser.add_argument_group("analysis options").add_arguments({
+        argparse::argument_spec<bool,OnOff>(bulk_args.timing, "--timing")
+            .show_in(argparse::ShowIn::HELP_ONLY)
+            .default_value("on"),
+    });
+    if (bulk_parser.fingerprint() != chained_parser.fingerprint()
+        || bulk_parser.schema().to_json() != chained_parser.schema().to_json()) {
+        std::cout << "[FAIL] Bulk registered arguments differ from individually added arguments" << std::endl;
+        ++num_failed;
+    }
+    bulk_parser.parse_args_throw({"top.blif", "-v", "--seed", "3", "--weights", "2,4"});
+    if (bulk_args.circuit.value() != "top.blif" || !bulk_args.verbose || bulk_args.seed != 3
+        || bulk_args.weights.value() != std::vector<double>({2., 4.}) || !bulk_args.timing) {
+        std::cout << "[FAIL] Unexpected values from bulk registered arguments" << std::endl;
+        ++num_failed;
+    }
+    try {
+        bulk_parser.add_arguments({
+            argparse::argument_spec(bulk_args.seed, "--good_seed"),
+            argparse::argument_spec(bulk_args.seed, "--bad_seed").action(argparse::Action::STORE_TRUE),
+        });
+        std::cout << "[FAIL] Accepted invalid argument specification" << std::endl;
+        ++num_failed;
+    } catch (const argparse::ArgParseError& err) {
+        if (std::string(err.what()) != "Non-boolean destination can not have STORE_TRUE action (--bad_seed)") {
+            std::cout << "[FAIL] Unexpected argument specification error '" << err.what() << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+    //None of the rejected specifications' arguments are registered
+    std::string bulk_schema = bulk_parser.schema().to_json();
+    if (bulk_schema.find("--bad_seed") != std::string::npos || bulk_schema.find("--good_seed") != std::string::npos) {
+        std::cout << "[FAIL] Rejected argument specifications left arguments registered" << std::endl;
+        ++num_failed;
+    }
+
+    //Static (referenced) help text
+    {
+        ArgValue<int> static_seed;
+        ArgValue<int> static_effort;
+        std::stringstream static_help;
+        auto static_parser = argparse::ArgumentParser(argv[0], argparse::StaticText("Static description"), static_help);
+        static_parser.epilog(argparse::StaticText("Static epilog"));
+        static_parser.add_argument(static_seed, "--seed")
+                .help(argparse::StaticText("Static seed help"));
+        static_parser.add_argument_group("static options")
+                .epilog(argparse::StaticText("Static group epilog"))
+                .add_argument(static_effort, "--effort");
+        static_parser.print_help();
+        for (const char* text : {"Static description", "Static epilog", "Static seed help", "Static group epilog"}) {
+            if (static_help.str().find(text) == std::string::npos) {
+                std::cout << "[FAIL] Help missing static text '" << text << "'" << std::endl;
+                ++num_failed;
+            }
+        }
+    }
+
+    //Configuration fingerprints
+    struct FingerprintArgs {
+        ArgValue<int> seed;
+        ArgValue<int> effort;
+        ArgValue<bool> verbose;
+        ArgValue<std::string> router;
+    } fingerprint_args;
+    auto fingerprint_parser = argparse::ArgumentParser(argv[0], "Test configuration fingerprint parser");
+    fingerprint_parser.record_parse_state(true); //Re-parsed incrementally
+    {
+        auto& grp = fingerprint_parser.add_argument_group("place options");
+        grp.add_argument<int,CountedInt>(fingerprint_args.seed, "--seed")
+                .default_value("1");
+        grp.add_argument<int,CountedInt>(fingerprint_args.effort, "--effort")
+                .default_value("1");
+    }
+    fingerprint_parser.add_argument(fingerprint_args.verbose, "--verbose")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false")
+            .in_config_fingerprint(false);
+    fingerprint_parser.add_argument_group("route options")
+            .add_argument(fingerprint_args.router, "--router")
+            .default_value("timing_driven");
+    const auto& fingerprint_place_grp = fingerprint_parser.argument_groups()[1];
+    const auto& fingerprint_route_grp = fingerprint_parser.argument_groups()[2];
+
+    fingerprint_parser.parse_args_throw({"--seed", "2"});
+    uint64_t definition_fingerprint = fingerprint_parser.fingerprint(); //After the lazily added help option
+    uint64_t config_fingerprint = fingerprint_parser.config_fingerprint();
+    uint64_t place_fingerprint = fingerprint_place_grp.config_fingerprint();
+    uint64_t route_fingerprint = fingerprint_route_grp.config_fingerprint();
+
+    //Canonical values, and excluded arguments, give the same fingerprint
+    CountedInt::num_to_strs = 0;
+    fingerprint_parser.reparse_args_throw(fingerprint_parser.parse_state(), {"--seed", "02", "--verbose"});
+    if (fingerprint_parser.config_fingerprint() != config_fingerprint || CountedInt::num_to_strs != 1) {
+        std::cout << "[FAIL] Unexpected configuration fingerprint for equivalent values (" << CountedInt::num_to_strs << " re-hashed)" << std::endl;
+        ++num_failed;
+    }
+
+    //Only the changed option is re-hashed, and only its group's fingerprint changes
+    CountedInt::num_to_strs = 0;
+    fingerprint_parser.reparse_args_throw(fingerprint_parser.parse_state(), {"--seed", "02", "--verbose", "--router", "breadth_first"});
+    if (fingerprint_parser.config_fingerprint() == config_fingerprint
+        || fingerprint_place_grp.config_fingerprint() != place_fingerprint
+        || fingerprint_route_grp.config_fingerprint() == route_fingerprint
+        || CountedInt::num_to_strs != 0) {
+        std::cout << "[FAIL] Unexpected configuration fingerprint after changing --router" << std::endl;
+        ++num_failed;
+    }
+    fingerprint_parser.reparse_args_throw(fingerprint_parser.parse_state(), {"--effort", "3"});
+    if (fingerprint_place_grp.config_fingerprint() == place_fingerprint || fingerprint_route_grp.config_fingerprint() != route_fingerprint) {
+        std::cout << "[FAIL] Unexpected group configuration fingerprints after changing --effort" << std::endl;
+        ++num_failed;
+    }
+    if (fingerprint_parser.fingerprint() != definition_fingerprint) {
+        std::cout << "[FAIL] Parser definition fingerprint changed by parsing and configuration fingerprints" << std::endl;
+        ++num_failed;
+    }
+
+    //Options sharing a destination both observe every write to it
+    ArgValue<bool> shared_verbosity;
+    auto shared_dest_parser = argparse::ArgumentParser(argv[0], "Test shared destination fingerprint parser");
+    shared_dest_parser.add_argument(shared_verbosity, "--verbose")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false");
+    shared_dest_parser.add_argument(shared_verbosity, "--quiet")
+            .action(argparse::Action::STORE_FALSE);
+    shared_dest_parser.parse_args_throw({"--verbose"});
+    uint64_t verbose_fingerprint = shared_dest_parser.config_fingerprint();
+    shared_dest_parser.parse_args_throw({"--quiet"});
+    uint64_t quiet_fingerprint = shared_dest_parser.config_fingerprint();
+    shared_dest_parser.parse_args_throw({"--verbose"}); //Writes the destination only through --verbose
+    if (verbose_fingerprint == quiet_fingerprint || shared_dest_parser.config_fingerprint() != verbose_fingerprint) {
+        std::cout << "[FAIL] Stale configuration fingerprint for options sharing a destination" << std::endl;
+        ++num_failed;
+    }
+
+    //Sub-commands
+    struct SubArgs {
+        ArgValue<bool> verbose;
+        ArgValue<int> effort;
+        ArgValue<std::string> router;
+    } sub_args;
+    int num_subparsers_built = 0;
+
+    auto sub_parser = argparse::ArgumentParser(argv[0], "Test sub-command parser");
+    sub_parser.add_argument(sub_args.verbose, "--verbose")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false");
+    sub_parser.add_subcommand("pack", [&](argparse::ArgumentParser& pack_parser) {
+                ++num_subparsers_built;
+                pack_parser.add_argument(sub_args.effort, "--effort")
+                        .default_value("1");
+            }, "Run packing");
+    sub_parser.add_subcommand("route", [&](argparse::ArgumentParser& route_parser) {
+                ++num_subparsers_built;
+                route_parser.add_argument(sub_args.router, "router")
+                        .choices({"breadth_first", "timing_driven"});
+            }, "Run routing");
+    sub_parser.print_help();
+    if (num_subparsers_built != 0) {
+        std::cout << "[FAIL] Sub-command parsers constructed when printing help" << std::endl;
+        ++num_failed;
+    }
+
+    std::vector<std::vector<std::string>> subcommand_pass_cases = {
+        {}, //No sub-command
+        {"--verbose", "pack"},
+        {"pack", "--effort", "3"},
+        {"--verbose", "route", "timing_driven"},
+    };
+    for(const auto& cmd_line : subcommand_pass_cases) {
+        if(!expect_pass(sub_parser, cmd_line)) {
+            std::cout << "       Failed to parse: '" << argparse::join(cmd_line, " ") << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+
+    std::vector<std::vector<std::string>> subcommand_fail_cases = {
+        {"pak"}, //Unknown sub-command
+        {"pack", "--verbose"}, //Parent option after sub-command
+        {"route"}, //Missing sub-command positional
+        {"pack", "route", "timing_driven"}, //Multiple sub-commands
+    };
+    for(const auto& cmd_line : subcommand_fail_cases) {
+        if(!expect_fail(sub_parser, cmd_line)) {
+            std::cout << "       Parsed successfully when expected failure: '" << argparse::join(cmd_line, " ") << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+    argparse::ParserSchema sub_schema = argparse::ParserSchema::from_json(sub_parser.schema().to_json());
+    for (const auto& cmd_line : subcommand_pass_cases) {
+        try {
+            sub_schema.validate(cmd_line);
+        } catch (const argparse::ArgParseError& err) {
+            std::cout << "[FAIL] Sub-command schema rejected '" << argparse::join(cmd_line, " ") << "': " << err.what() << std::endl;
+            ++num_failed;
+        }
+    }
+    for (const auto& cmd_line : subcommand_fail_cases) {
+        try {
+            sub_schema.validate(cmd_line);
+            std::cout << "[FAIL] Sub-command schema accepted '" << argparse::join(cmd_line, " ") << "'" << std::endl;
+            ++num_failed;
+        } catch (const argparse::ArgParseError&) {
+        }
+    }
+
+    //Serialized command-lines round-trip through multi value options before a sub-command, and values starting with '-'
+    struct RoundTripArgs {
+        ArgValue<std::vector<std::string>> tags;
+        ArgValue<int> offset;
+        ArgValue<std::string> label;
+        ArgValue<int> effort;
+    } round_trip_args;
+    auto round_trip_parser = argparse::ArgumentParser(argv[0], "Test serialization round-trip parser");
+    round_trip_parser.add_argument(round_trip_args.tags, "--tags")
+            .nargs('*');
+    round_trip_parser.add_argument(round_trip_args.offset, "--offset", "-o");
+    round_trip_parser.add_argument(round_trip_args.label, "--label", "-l");
+    round_trip_parser.add_subcommand("pack", [&](argparse::ArgumentParser& pack_parser) {
+                pack_parser.add_argument(round_trip_args.effort, "--effort");
+            }, "Run packing");
+    auto describe_round_trip = [&]() {
+        std::stringstream ss;
+        ss << argparse::join(round_trip_args.tags.value(), ",") << ";" << round_trip_args.offset.value() << ";"
+           << round_trip_args.label.value() << ";" << round_trip_parser.selected_subcommand() << ";" << round_trip_args.effort.value();
+        return ss.str();
+    };
+    std::vector<std::vector<std::string>> round_trip_cases = {
+        {"--tags", "a", "b", "--", "pack", "--effort", "2"}, //'--' ends the values before the sub-command
+        {"--tags", "--", "pack"},
+        {"--offset", "-5", "--label", "-x", "--tags", "-3", "pack"}, //Values starting with '-' which are not options
+    };
+    for (const auto& cmd_line : round_trip_cases) {
+        round_trip_parser.parse_args_throw(cmd_line);
+        auto specified = describe_round_trip();
+        auto round_trip_args_strs = round_trip_parser.serialize_args("vpr").args();
+
+        round_trip_parser.reset_destinations();
+        round_trip_parser.parse_args_throw(std::vector<std::string>(round_trip_args_strs.begin() + 1, round_trip_args_strs.end()));
+        if (describe_round_trip() != specified) {
+            std::cout << "[FAIL] Serialized '" << argparse::join(cmd_line, " ") << "' as '" << argparse::join(round_trip_args_strs, " ")
+                      << "' which parsed as '" << describe_round_trip() << "' expected '" << specified << "'" << std::endl;
+            ++num_failed;
+        }
+        round_trip_parser.reset_destinations();
+    }
+    round_trip_parser.parse_args_throw(std::vector<std::string>{"-l-o5"}); //Value which would be re-parsed as an option
+    try {
+        round_trip_parser.serialize_args("vpr");
+        std::cout << "[FAIL] Serialized a value which would be parsed as an option" << std::endl;
+        ++num_failed;
+    } catch (const argparse::ArgParseError& err) {
+        if (err.what() != std::string("Can not serialize the value '-o5' of --label/-l, which would be parsed as an option")) {
+            std::cout << "[FAIL] Unexpected serialization error '" << err.what() << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+    round_trip_parser.reset_destinations();
+
+    //Multi value positionals take all the remaining positional values, optionally passed on in chunks
+    struct FileArgs {
+        ArgValue<bool> verbose;
+        ArgValue<std::vector<std::string>> files;
+    } file_args;
+    auto file_parser = argparse::ArgumentParser(argv[0], "Test multi value positional parser");
+    file_parser.add_argument(file_args.verbose, "--verbose")
+            .action(argparse::Action::STORE_TRUE)
+            .default_value("false");
+    auto& files_arg = file_parser.add_argument(file_args.files, "files")
+            .nargs('+');
+    std::vector<std::string> files_cmd_line = {"a.blif", "--verbose", "b.blif", "c.blif"};
+    file_parser.parse_args_throw(files_cmd_line);
+    if (file_args.files.value() != std::vector<std::string>({"a.blif", "b.blif", "c.blif"})
+        || !expect_fail(file_parser, {"--verbose"})) {
+        std::cout << "[FAIL] Unexpected multi value positional values" << std::endl;
+        ++num_failed;
+    }
+    std::vector<std::vector<std::string>> file_chunks;
+    files_arg.chunked<std::string>(2, [&](std::vector<std::string>& chunk) {
+                file_chunks.push_back(chunk);
+            });
+    file_parser.parse_args_throw(files_cmd_line);
+    if (file_chunks != std::vector<std::vector<std::string>>({{"a.blif", "b.blif"}, {"c.blif"}})
+        || !file_args.files.value().empty()
+        || file_args.verbose != true) {
+        std::cout << "[FAIL] Unexpected chunks of multi value positional" << std::endl;
+        ++num_failed;
+    }
+
+    //Character destinations take a single character per value
+    struct CharArgs {
+        ArgValue<char> separator;
+        ArgValue<std::vector<unsigned char>> flags;
+    } char_args;
+    auto char_parser = argparse::ArgumentParser(argv[0], "Test character parser");
+    char_parser.add_argument(char_args.separator, "--separator");
+    char_parser.add_argument(char_args.flags, "--flags")
+            .nargs('+');
+    char_parser.parse_args_throw(std::vector<std::string>{"--separator", ";", "--flags", "a", "b"});
+    if (char_args.separator != ';'
+        || char_args.flags.value() != std::vector<unsigned char>({'a', 'b'})
+        || !expect_fail(char_parser, {"--separator", "ab"})) {
+        std::cout << "[FAIL] Unexpected character values" << std::endl;
+        ++num_failed;
+    }
+
+    //Delimited lists are split into the destination vector
+    struct ListArgs {
+        ArgValue<std::vector<float>> weights;
+        ArgValue<std::vector<unsigned>> pins;
+        ArgValue<std::vector<std::string>> names;
+    } list_args;
+    auto list_parser = argparse::ArgumentParser(argv[0], "Test delimited list parser");
+    list_parser.add_argument(list_args.weights, "--weights")
+            .delimiter(',')
+            .default_value("1,1");
+    list_parser.add_argument(list_args.pins, "--pins")
+            .delimiter(':');
+    list_parser.add_argument(list_args.names, "--names")
+            .nargs('+')
+            .delimiter(',');
+    list_parser.parse_args_throw(std::vector<std::string>{"--pins", "1:2:30", "--names", "a,b", "c"});
+    if (list_args.weights.value() != std::vector<float>({1., 1.})
+        || list_args.pins.value() != std::vector<unsigned>({1, 2, 30})
+        || list_args.names.value() != std::vector<std::string>({"a", "b", "c"})) {
+        std::cout << "[FAIL] Unexpected delimited list values" << std::endl;
+        ++num_failed;
+    }
+    list_parser.reset_destinations();
+    list_parser.parse_args_throw(std::vector<std::string>{"--weights", "0.5,0.25,2", "--pins", "4"});
+    if (list_args.weights.value() != std::vector<float>({0.5, 0.25, 2.})
+        || list_args.pins.value() != std::vector<unsigned>({4})) {
+        std::cout << "[FAIL] Unexpected delimited list values" << std::endl;
+        ++num_failed;
+    }
+    list_parser.reset_destinations();
+    std::vector<std::pair<std::vector<std::string>,std::string>> list_fail_cases = {
+        {{"--pins", "1:-2:3"}, "Invalid conversion from '-2' to non-negative integer (field 2) for --pins"},
+        {{"--weights", "0.5,,2"}, "Invalid conversion from '' to float (field 2) for --weights"},
+        {{"--weights", "0.5,inf"}, "Invalid conversion from 'inf' to float (field 2) for --weights"},
+    };
+    for (const auto& list_fail_case : list_fail_cases) {
+        try {
+            list_parser.parse_args_throw(list_fail_case.first);
+            std::cout << "[FAIL] Parsed delimited list '" << argparse::join(list_fail_case.first, " ") << "' when expected failure" << std::endl;
+            ++num_failed;
+        } catch (const argparse::ArgParseError& err) {
+            if (err.what() != list_fail_case.second) {
+                std::cout << "[FAIL] Unexpected delimited list error '" << err.what() << "' expected '" << list_fail_case.second << "'" << std::endl;
+                ++num_failed;
+            }
+        }
+        list_parser.reset_destinations();
+    }
+
+    //Asynchronous conversions complete before the parse returns, with errors reported in command-line order
+    struct AsyncArgs {
+        ArgValue<int> seed;
+        ArgValue<std::vector<int>> sizes;
+    } async_args;
+    auto async_parser = argparse::ArgumentParser(argv[0], "Test asynchronous conversion parser");
+    async_parser.async_conversion_threads(2);
+    async_parser.add_argument<int,AsyncInt>(async_args.seed, "--seed")
+            .default_value("1");
+    async_parser.add_argument<int,AsyncInt>(async_args.sizes, "sizes")
+            .nargs('+');
+    async_parser.parse_args_throw(std::vector<std::string>{"4", "--seed", "7", "5", "6"});
+    if (async_args.seed != 7
+        || async_args.sizes.value() != std::vector<int>({4, 5, 6})) {
+        std::cout << "[FAIL] Unexpected asynchronously converted values" << std::endl;
+        ++num_failed;
+    }
+    async_parser.reset_destinations();
+    std::vector<std::pair<std::vector<std::string>,std::string>> async_fail_cases = {
+        {{"4", "x", "--seed", "y"}, "Invalid conversion from 'x' to integer for positional argument sizes"},
+        {{"--seed", "y", "x"}, "Invalid conversion from 'y' to integer for --seed"},
+    };
+    for (const auto& async_fail_case : async_fail_cases) {
+        try {
+            async_parser.parse_args_throw(async_fail_case.first);
+            std::cout << "[FAIL] Parsed '" << argparse::join(async_fail_case.first, " ") << "' when expected failure" << std::endl;
+            ++num_failed;
+        } catch (const argparse::ArgParseError& err) {
+            if (err.what() != async_fail_case.second) {
+                std::cout << "[FAIL] Unexpected asynchronous conversion error '" << err.what() << "' expected '" << async_fail_case.second << "'" << std::endl;
+                ++num_failed;
+            }
+        }
+        async_parser.reset_destinations();
+    }
+
+    //The earliest conversion error is reported whether it was asynchronous or not (in both streamed and recorded parses)
+    ArgValue<int> mixed_seed;
+    ArgValue<int> mixed_count;
+    auto mixed_parser = argparse::ArgumentParser(argv[0], "Test mixed conversion parser");
+    mixed_parser.add_argument<int,AsyncInt>(mixed_seed, "--seed");
+    mixed_parser.add_argument(mixed_count, "count"); //Converted synchronously
+    std::vector<std::pair<std::vector<std::string>,std::string>> mixed_fail_cases = {
+        {{"--seed", "y", "x"}, "Invalid conversion from 'y' to integer for --seed"},
+        {{"x", "--seed", "y"}, "Invalid conversion from 'x' to integer for positional argument count"},
+    };
+    for (bool record : {false, true}) {
+        mixed_parser.record_parse_state(record);
+        for (const auto& mixed_fail_case : mixed_fail_cases) {
+            try {
+                mixed_parser.parse_args_throw(mixed_fail_case.first);
+                std::cout << "[FAIL] Parsed '" << argparse::join(mixed_fail_case.first, " ") << "' when expected failure" << std::endl;
+                ++num_failed;
+            } catch (const argparse::ArgParseError& err) {
+                if (err.what() != mixed_fail_case.second) {
+                    std::cout << "[FAIL] Unexpected mixed conversion error '" << err.what() << "' expected '" << mixed_fail_case.second << "'" << std::endl;
+                    ++num_failed;
+                }
+            }
+            mixed_parser.reset_destinations();
+        }
+    }
+
+    //Event-driven parsing reports each argument without setting destinations
+    struct EventRecorder : public argparse::ParseHandler {
+        std::vector<std::string> events;
+
+        void on_option(const argparse::Argument& /*arg*/, const std::string& option_str) override { events.push_back("option " + option_str); }
+        void on_value(const argparse::Argument& arg, const std::string& value) override { events.push_back("value " + arg.name() + "=" + value); }
+        void on_positional(const argparse::Argument& arg, const std::string& value) override { events.push_back("positional " + arg.name() + "=" + value); }
+        void on_subcommand(const argparse::ArgumentParser& /*subparser*/, const std::string& name) override { events.push_back("subcommand " + name); }
+        void on_error(const argparse::ArgParseError& error) override { events.push_back(std::string("error ") + error.what()); }
+        void on_end() override { events.push_back("end"); }
+    };
+    std::vector<std::pair<std::vector<std::string>,std::vector<std::string>>> event_cases = {
+        {{"--verbose", "route", "timing_driven"}, {"option --verbose", "subcommand route", "positional router=timing_driven", "end"}},
+        {{"pack", "--effort", "3"}, {"subcommand pack", "option --effort", "value --effort=3", "end"}},
+        {{"route"}, {"subcommand route", "error Missing required positional argument: router"}},
+    };
+    sub_parser.reset_destinations();
+    for (const auto& event_case : event_cases) {
+        EventRecorder recorder;
+        bool success = sub_parser.parse_events(event_case.first, recorder);
+        if (success != (recorder.events.back() == "end")
+            || recorder.events != event_case.second
+            || sub_args.verbose.provenance() != argparse::Provenance::UNSPECIFIED
+            || sub_args.effort.provenance() != argparse::Provenance::UNSPECIFIED) {
+            std::cout << "[FAIL] Unexpected events for '" << argparse::join(event_case.first, " ") << "': '" << argparse::join(recorder.events, "; ") << "'" << std::endl;
+            ++num_failed;
+        }
+    }
+
+    //A frozen parser may be shared by threads parsing events, which share its conversion memos
+    struct FrozenArgs {
+        ArgValue<int> effort;
+        ArgValue<std::vector<int>> sizes;
+    } frozen_args;
+    auto frozen_parser = argparse::ArgumentParser(argv[0], "Test frozen parser");
+    auto& frozen_effort_arg = frozen_parser.add_argument(frozen_args.effort, "--effort")
+            .memoize(4);
+    frozen_parser.add_argument(frozen_args.sizes, "--sizes")
+            .nargs('+')
+            .memoize(4);
+    frozen_parser.collect_parse_stats(true);
+    frozen_parser.freeze();
+
+    const size_t num_frozen_parses = 500;
+    std::vector<size_t> frozen_failures(2, 0);
+    std::vector<std::thread> frozen_threads;
+    for (size_t thread = 0; thread < frozen_failures.size(); ++thread) {
+        frozen_threads.emplace_back([&, thread] {
+            for (size_t i = 0; i < num_frozen_parses; ++i) {
+                std::string effort = std::to_string((i + thread) % 3);
+                EventRecorder recorder;
+                if (!frozen_parser.parse_events({"--effort", effort, "--sizes", "1", "2"}, recorder)
+                    || recorder.events.size() != 6
+                    || recorder.events[1] != "value --effort=" + effort) {
+                    ++frozen_failures[thread];
+                }
+
+                EventRecorder error_recorder;
+                if (frozen_parser.parse_events({"--effort", "x"}, error_recorder)
+                    || error_recorder.events.back() != "error Missing expected argument for --effort") {
+                    ++frozen_failures[thread];
+                }
+            }
+        });
+    }
+    for (auto& frozen_thread : frozen_threads) {
+        frozen_thread.join();
+    }
+
+    bool frozen_add_threw = false;
+    try {
+        frozen_parser.add_argument(frozen_args.effort, "--other_effort");
+    } catch (const argparse::ArgParseError&) {
+        frozen_add_threw = true;
+    }
+    argparse::MemoStats frozen_memo_stats = frozen_effort_arg.memo_stats();
+    if (frozen_failures[0] + frozen_failures[1] != 0
+        || frozen_memo_stats.hits + frozen_memo_stats.misses != 2 * 2 * num_frozen_parses
+        || frozen_memo_stats.misses < 4
+        || frozen_memo_stats.size != 4
+        || frozen_parser.parse_stats() != nullptr
+        || !frozen_add_threw) {
+        std::cout << "[FAIL] Unexpected concurrent parses of a frozen parser (" << frozen_failures[0] + frozen_failures[1] << " failed, "
+                  << frozen_memo_stats.hits << " hits, " << frozen_memo_stats.misses << " misses)" << std::endl;
+        ++num_failed;
+    }
+
+    if (num_subparsers_built != 2) {
+        std::cout << "[FAIL] Expected each sub-command parser to be constructed once (constructed " << num_subparsers_built << ")" << std::endl;
+        ++num_failed;
+    }
+
     if (num_failed != 0) {
         std::cout << "\n";
         std::cout << "FAILED: " << num_failed << " test(s)!" << "\n";
@@ -578,3 +1565,43 @@ bool expect_fail(argparse::ArgumentParser& parser, std::vector<std::string> cmd_
     parser.reset_destinations();
     return false;
 }
+
+bool expect_fail_message(argparse::ArgumentParser& parser, std::vector<std::string> cmd_line, std::string expected_msg) {
+    try {
+        parser.parse_args_throw(cmd_line);
+    } catch(const argparse::ArgParseError& err) {
+        parser.reset_destinations();
+        if (std::string(err.what()).find(expected_msg) == std::string::npos) {
+            std::cout << "[FAIL] " << err.what() << std::endl;
+            return false;
+        }
+        std::cout << "[PASS] " << err.what() << std::endl;
+        return true;
+    }
+    std::cout << "[FAIL] Parsed OK when expected fail" << std::endl;
+    parser.reset_destinations();
+    return false;
+}
+
+#ifndef _WIN32
+std::string make_temp_dir() {
+    char dir[] = "/tmp/argparse_test.XXXXXX";
+    if (!mkdtemp(dir)) {
+        throw std::runtime_error("Failed to create temporary directory");
+    }
+    return dir;
+}
+
+void remove_temp_dir(const std::string& dir) {
+    if (DIR* entries = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(entries)) {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..") {
+                unlink((dir + "/" + name).c_str());
+            }
+        }
+        closedir(entries);
+    }
+    rmdir(dir.c_str());
+}
+#endif
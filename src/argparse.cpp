@@ -1,16 +1,294 @@
 #include <algorithm>
 #include <array>
-#include <list>
 #include <cassert>
+#include <cstring>
+#include <functional>
 #include <string>
-#include <set>
-#include <limits>
+#include <thread>
 
 #include "argparse.hpp"
+#include "argparse_cache.hpp"
+#include "argparse_stats.hpp"
+#include "argparse_token_resolver.hpp"
 #include "argparse_util.hpp"
 
 namespace argparse {
 
+    static uint64_t mix_hash(uint64_t hash);
+
+    /*
+     * Handlers and token sources used internally by parsing
+     */
+
+    //Builds the ParseState of a parse, acting on help and version options.
+    //If state is null the parse is not recorded (see ArgumentParser::record_parse_state()), and the
+    //destinations are instead set as each argument is resolved, so the command-line is never held in memory.
+    //The values of chunked arguments are always set (and passed on in chunks) immediately
+    class ArgumentParser::StateBuilder : public ParseHandler {
+        public:
+            StateBuilder(ArgumentParser& parser, ParseState* state)
+                : parser_(parser)
+                , argument_table_(*parser.argument_table_)
+                , state_(state)
+                , specified_arguments_(state ? 0 : argument_table_.size(), false) {}
+
+            //Passes the remaining values of all chunked arguments on, and completes the asynchronous
+            //conversions of an unrecorded parse (setting their destinations in command-line order)
+            void finish() {
+                for (ArgumentId id : chunked_args_) {
+                    argument_table_.argument(id).flush_dest_chunk(true);
+                }
+
+                ConversionFailure failure;
+                parser_.finish_pending_stores(pending_stores_, failure);
+            }
+
+            //Returns which arguments were specified by an unrecorded parse
+            const std::vector<bool>& specified_arguments() const { return specified_arguments_; }
+
+            void on_option(const Argument& arg, const std::string& /*option_str*/) override {
+                if (arg.action() == Action::HELP) {
+                    argument_table_.argument(arg.id()).set_dest_to_true();
+                    throw ArgParseHelp();
+                } else if (arg.action() == Action::VERSION) {
+                    argument_table_.argument(arg.id()).set_dest_to_true();
+                    throw ArgParseVersion();
+                }
+
+                if (state_) {
+                    add_occurrence(arg);
+                    return;
+                }
+
+                specified_arguments_[arg.id()] = true;
+                if (arg.action() == Action::STORE_TRUE) {
+                    argument_table_.argument(arg.id()).set_dest_to_true();
+                } else if (arg.action() == Action::STORE_FALSE) {
+                    argument_table_.argument(arg.id()).set_dest_to_false();
+                }
+            }
+
+            void on_value(const Argument& arg, const std::string& value) override {
+                if (state_) {
+                    state_->add_value(value);
+                    return;
+                }
+                store_value(arg, value);
+            }
+
+            void on_positional(const Argument& arg, const std::string& value) override {
+                if (arg.is_chunked()) {
+                    Argument& target = argument_table_.argument(arg.id());
+                    if (std::find(chunked_args_.begin(), chunked_args_.end(), arg.id()) == chunked_args_.end()) {
+                        //First value, recorded (without values) so the argument is known to be specified
+                        chunked_args_.push_back(arg.id());
+                        target.reset_dest();
+
+                        if (state_) {
+                            add_occurrence(arg);
+                        } else {
+                            specified_arguments_[arg.id()] = true;
+                        }
+                    }
+
+                    parser_.apply_positional_value(target, value);
+                    target.flush_dest_chunk(false);
+                    return;
+                }
+
+                if (state_) {
+                    add_occurrence(arg);
+                    state_->add_value(value);
+                    return;
+                }
+
+                specified_arguments_[arg.id()] = true;
+                store_value(arg, value);
+            }
+        private:
+            //Records a new occurrence of arg (with no values yet)
+            void add_occurrence(const Argument& arg) {
+                ParseState::Occurrence occurrence;
+                occurrence.arg = arg.id();
+                occurrence.first = state_->args_.size();
+                occurrence.last = occurrence.first;
+                state_->occurrences_.push_back(occurrence);
+            }
+
+            //Sets (or adds to) arg's destination from value
+            void store_value(const Argument& arg, const std::string& value) {
+                ParseStats* stats = parser_.parse_stats_.get();
+                ScopedTimer arg_timer(stats ? &stats->argument_conversion[arg.id()] : nullptr);
+                if (stats) {
+                    ++stats->argument_conversions[arg.id()];
+                    ++stats->num_conversions;
+                }
+
+                Argument& target = argument_table_.argument(arg.id());
+                size_t order = num_values_++;
+                try {
+                    parser_.store_value(target, value, &pending_stores_, order);
+                } catch (const ArgParseConversionError& e) {
+                    //Reported once the earlier asynchronous conversions have completed (as they may also fail)
+                    ConversionFailure failure;
+                    failure.record(parser_, target, order, e);
+                    parser_.finish_pending_stores(pending_stores_, failure);
+                }
+            }
+        private:
+            ArgumentParser& parser_;
+            ArgumentTable& argument_table_;
+            ParseState* state_;
+            std::vector<ArgumentId> chunked_args_; //Chunked arguments specified so far
+            std::vector<bool> specified_arguments_; //Indexed by ArgumentId (unrecorded parses only)
+            std::vector<PendingStore> pending_stores_; //Asynchronous conversions (unrecorded parses only)
+            size_t num_values_ = 0; //Values stored so far (unrecorded parses only)
+    };
+
+    //Records which arguments were specified (for check_required()), passing all events on to handler
+    class ArgumentParser::RequiredTracker : public ParseHandler {
+        public:
+            RequiredTracker(ParseHandler& handler, size_t num_arguments)
+                : handler_(handler)
+                , specified_arguments_(num_arguments, false) {}
+
+            void on_option(const Argument& arg, const std::string& option_str) override {
+                specified_arguments_[arg.id()] = true;
+                handler_.on_option(arg, option_str);
+            }
+
+            void on_value(const Argument& arg, const std::string& value) override {
+                handler_.on_value(arg, value);
+            }
+
+            void on_positional(const Argument& arg, const std::string& value) override {
+                specified_arguments_[arg.id()] = true;
+                handler_.on_positional(arg, value);
+            }
+
+            void on_subcommand(const ArgumentParser& subparser, const std::string& name) override {
+                handler_.on_subcommand(subparser, name);
+            }
+
+            const std::vector<bool>& specified_arguments() const { return specified_arguments_; }
+        private:
+            ParseHandler& handler_;
+            std::vector<bool> specified_arguments_;
+    };
+
+    //The parser's argument definitions, as used to resolve and check command-lines
+    class ArgumentParser::ParserArguments : public ArgumentMetadata {
+        public:
+            explicit ParserArguments(const ArgumentParser& parser)
+                : parser_(parser)
+                , argument_table_(*parser.argument_table_) {}
+
+            const std::vector<ArgumentHot>& hot_table() const override { return argument_table_.hot_table(); }
+
+            const std::string& argument_name(ArgumentId id) const override {
+                return argument_table_.argument(id).name();
+            }
+
+            const std::vector<std::string>& argument_choices(ArgumentId id) const override {
+                return argument_table_.argument(id).choices();
+            }
+
+            std::vector<std::string> suggest_choices(ArgumentId id, const std::string& value) const override {
+                return argument_table_.argument(id).suggest_choices(value);
+            }
+
+            bool is_convertible_value(ArgumentId id, const std::string& value) const override {
+                const Argument& arg = argument_table_.argument(id);
+                if (arg.delimiter()) {
+                    return arg.value_ops().is_convertible_fields(value, arg.delimiter(), nullptr);
+                }
+                return arg.value_ops().is_convertible(arg, value);
+            }
+
+            std::string field_error(ArgumentId id, const std::string& value) const override {
+                const Argument& arg = argument_table_.argument(id);
+                std::string error;
+                arg.value_ops().is_convertible_fields(value, arg.delimiter(), &error);
+                return error;
+            }
+
+            std::vector<std::string> suggest_options(const std::string& str, const OptionTable& options) const override {
+                return parser_.suggest_options(str, options.str_to_option_arg);
+            }
+
+            std::vector<std::string> subcommand_names() const override { return parser_.subcommands(); }
+
+            bool subcommand_required() const override { return parser_.subcommand_required_; }
+        private:
+            const ArgumentParser& parser_;
+            const ArgumentTable& argument_table_;
+    };
+
+    //Reports the resolved tokens of a parse to handler
+    class ArgumentParser::HandlerTokenResolver : public TokenResolver {
+        public:
+            HandlerTokenResolver(ArgumentParser& parser, const ParserArguments& args, const OptionTable& options, ParseHandler& handler)
+                : TokenResolver(args, options)
+                , parser_(parser)
+                , handler_(handler) {}
+        protected:
+            void on_option(ArgumentId id, const std::string& option_str) override {
+                handler_.on_option(parser_.argument(id), option_str);
+            }
+
+            void on_value(ArgumentId id, const std::string& value) override {
+                handler_.on_value(parser_.argument(id), value);
+            }
+
+            void on_positional(ArgumentId id, const std::string& value) override {
+                handler_.on_positional(parser_.argument(id), value);
+            }
+
+            void on_subcommand(int index, const std::string& name) override {
+                handler_.on_subcommand(parser_.subparser_for(index), name);
+            }
+        private:
+            ArgumentParser& parser_;
+            ParseHandler& handler_;
+    };
+
+    //Reads the tokens of a parse from source, removing the parse statistics flag.
+    //If args is non-null the tokens are also appended to it
+    class ArgumentParser::ParseTokenSource : public TokenSource {
+        public:
+            ParseTokenSource(TokenSource& source, const std::string& parse_stats_flag, std::vector<std::string>* args)
+                : source_(source)
+                , parse_stats_flag_(parse_stats_flag)
+                , args_(args) {}
+
+            //Returns true if the parse statistics flag was read
+            bool stats_flag_found() const { return stats_flag_found_; }
+
+            //Returns the number of tokens read (excluding the statistics flag)
+            size_t num_tokens() const { return num_tokens_; }
+        protected:
+            bool read(std::string& token) override {
+                while (source_.next(token)) {
+                    if (!parse_stats_flag_.empty() && token == parse_stats_flag_) {
+                        stats_flag_found_ = true;
+                        continue;
+                    }
+
+                    ++num_tokens_;
+                    if (args_) {
+                        args_->push_back(token);
+                    }
+                    return true;
+                }
+                return false;
+            }
+        private:
+            TokenSource& source_;
+            const std::string& parse_stats_flag_;
+            std::vector<std::string>* args_;
+            bool stats_flag_found_ = false;
+            size_t num_tokens_ = 0;
+    };
 
     /*
      * ArgumentParser
@@ -18,11 +296,17 @@ namespace argparse {
 
     ArgumentParser::ArgumentParser(std::string prog_name, std::string description_str, std::ostream& os)
         : description_(description_str)
+        , argument_table_(std::make_shared<ArgumentTable>())
         , formatter_(new DefaultFormatter())
         , os_(os)
         {
         prog(prog_name);
-        argument_groups_.push_back(ArgumentGroup("arguments"));
+        argument_groups_.push_back(ArgumentGroup("arguments", argument_table_));
+    }
+
+    ArgumentParser::ArgumentParser(std::string prog_name, StaticText description_str, std::ostream& os)
+        : ArgumentParser(prog_name, std::string(), os) {
+        description_ = description_str;
     }
 
     ArgumentParser& ArgumentParser::prog(std::string prog_name, bool basename_only) {
@@ -44,285 +328,1059 @@ namespace argparse {
         return *this;
     }
 
+    ArgumentParser& ArgumentParser::epilog(StaticText epilog_str) {
+        epilog_ = epilog_str;
+        return *this;
+    }
+
+    ArgumentParser& ArgumentParser::add_arguments(std::vector<ArgumentSpec> specs) {
+        argument_groups_[0].add_arguments(std::move(specs));
+        return *this;
+    }
+
     ArgumentGroup& ArgumentParser::add_argument_group(std::string description_str) {
-        argument_groups_.push_back(ArgumentGroup(description_str));
+        argument_groups_.push_back(ArgumentGroup(description_str, argument_table_));
         return argument_groups_[argument_groups_.size() - 1];
     }
 
+    ArgumentParser& ArgumentParser::add_subcommand(std::string name, SubparserFactory factory, std::string help_str) {
+        argument_table_->check_not_frozen();
+        if (name.empty() || name[0] == '-') {
+            throw ArgParseError("Sub-command name must be non-empty and not start with '-'");
+        }
+        for (const auto& subcommand : subcommands_) {
+            if (subcommand.name == name) {
+                throw ArgParseError("Sub-command '" + name + "' specified multiple times");
+            }
+        }
+
+        Subcommand subcommand;
+        subcommand.name = name;
+        subcommand.help = help_str;
+        subcommand.factory = factory;
+        subcommands_.push_back(std::move(subcommand));
+        return *this;
+    }
+
+    ArgumentParser& ArgumentParser::subcommand_required(bool is_required) {
+        subcommand_required_ = is_required;
+        return *this;
+    }
+
+    ArgumentParser& ArgumentParser::mutually_exclusive(std::vector<std::string> args) {
+        ArgumentConstraint constraint;
+        constraint.kind = ArgumentConstraint::Kind::MUTUALLY_EXCLUSIVE;
+        constraint.args = constraint_arguments(args);
+        argument_table_->add_constraint(constraint);
+        return *this;
+    }
+
+    ArgumentParser& ArgumentParser::requires_arguments(std::string arg, std::vector<std::string> required_args) {
+        ArgumentConstraint constraint;
+        constraint.kind = ArgumentConstraint::Kind::REQUIRES;
+        constraint.arg = constraint_arguments({arg})[0];
+        constraint.args = constraint_arguments(required_args);
+        argument_table_->add_constraint(constraint);
+        return *this;
+    }
+
+    ArgumentParser& ArgumentParser::at_least_one_of(std::vector<std::string> args) {
+        ArgumentConstraint constraint;
+        constraint.kind = ArgumentConstraint::Kind::AT_LEAST_ONE;
+        constraint.args = constraint_arguments(args);
+        argument_table_->add_constraint(constraint);
+        return *this;
+    }
+
+    ArgumentParser& ArgumentParser::parse_cache_dir(std::string dir) {
+        parse_cache_dir_ = dir;
+        return *this;
+    }
+
     void ArgumentParser::parse_args(int argc, const char* const* argv, int error_exit_code, int help_exit_code, int version_exit_code) {
         try {
             parse_args_throw(argc, argv);
         } catch (const argparse::ArgParseHelp&) {
-            //Help requested
-            print_help();
+            //Help requested (report it for the sub-command, if one was selected)
+            active_parser().print_help();
             std::exit(help_exit_code);
         } catch (const argparse::ArgParseVersion&) {
-            print_version();
+            active_parser().print_version();
             std::exit(version_exit_code);
         } catch (const argparse::ArgParseError& e) {
             //Failed to parse
             std::cout << e.what() << "\n";
 
             std::cout << "\n";
-            print_usage();
+            active_parser().print_usage();
             std::exit(error_exit_code);
         }
     }
 
     void ArgumentParser::parse_args_throw(int argc, const char* const* argv) {
-        std::vector<std::string> arg_strs;
-        for (int i = 1; i < argc; ++i) {
-            arg_strs.push_back(argv[i]);
-        }
-
-        parse_args_throw(arg_strs);
+        ArgvTokenSource tokens(argc, argv);
+        parse_args_throw(tokens);
     }
     
     void ArgumentParser::parse_args_throw(std::vector<std::string> arg_strs) {
+        VectorTokenSource tokens(std::move(arg_strs));
+        parse_args_throw(tokens);
+    }
+
+    void ArgumentParser::parse_args_throw(TokenSource& source) {
+        parse_stats_ = start_parse_stats();
+
+        //The command-line is only recorded if required, so a streamed command-line is never held in memory.
+        //Chunked arguments' values are passed on as they are parsed, so their parses are never recorded
+        //(and can neither be cached nor incrementally re-parsed)
+        bool record = (record_parse_state_ || !parse_cache_dir_.empty()) && !has_chunked_arguments();
+
+        ParseState state;
+        ParseTokenSource parse_tokens(source, parse_stats_flag_, record ? &state.args_ : nullptr);
+
+        if (!record) {
+            ++parse_generation_;
+
+            stream_args(parse_tokens);
+
+            last_state_ = ParseState(); //Can not be incrementally re-parsed
+            finish_parse_stats(std::move(parse_stats_), parse_tokens.stats_flag_found(), parse_tokens.num_tokens());
+            return;
+        }
+
+        TokenSource* tokens = &parse_tokens;
+        std::unique_ptr<TokenSource> cached_tokens;
+        std::unique_ptr<ParseTokenSource> recorded_tokens;
+        if (!parse_cache_dir_.empty()) {
+            //The cache is looked up by the whole command-line, so it must all be read first
+            while (parse_tokens.peek()) {
+                parse_tokens.skip();
+            }
+
+            add_help_option_if_unspecified(); //Part of the fingerprint
+            if (load_cached_parse(state.args_)) {
+                //The occurrences were not resolved, so the state can not be incrementally re-parsed
+                state.parser_ = nullptr;
+                last_state_ = std::move(state);
+
+                finish_parse_stats(std::move(parse_stats_), parse_tokens.stats_flag_found(), last_state_.args_.size());
+                return;
+            }
+
+            //Re-read (and re-record) by the resolution, so the occurrences can refer to them
+            cached_tokens.reset(new VectorTokenSource(std::move(state.args_)));
+            state.args_.clear();
+            recorded_tokens.reset(new ParseTokenSource(*cached_tokens, parse_stats_flag_, &state.args_));
+            tokens = recorded_tokens.get();
+        }
+
+        ++parse_generation_;
+
+        resolve_args(*tokens, state);
+
+        apply_args(state, nullptr);
+
+        check_required(state);
+
+        if (!parse_cache_dir_.empty()) {
+            store_cached_parse(state);
+        }
+
+        state.parser_ = this;
+        state.generation_ = parse_generation_;
+        last_state_ = std::move(state);
+
+        finish_parse_stats(std::move(parse_stats_), parse_tokens.stats_flag_found(), parse_tokens.num_tokens());
+    }
+
+    void ArgumentParser::reparse_args_throw(const ParseState& previous, std::vector<std::string> arg_strs) {
+        //The destinations only reflect previous if nothing has modified them since
+        bool incremental = previous.parser_ == this
+                           && previous.generation_ == parse_generation_
+                           && previous.num_arguments_ == argument_table_->size();
+
+        if (!incremental) {
+            reset_destinations();
+            parse_args_throw(std::move(arg_strs));
+            return;
+        }
+
+        parse_stats_ = start_parse_stats();
+
+        VectorTokenSource source(std::move(arg_strs));
+        ParseState state;
+        ParseTokenSource tokens(source, parse_stats_flag_, &state.args_);
+
+        ++parse_generation_;
+
+        resolve_args(tokens, state);
+
+        apply_args(state, &previous);
+
+        check_required(state);
+
+        state.parser_ = this;
+        state.generation_ = parse_generation_;
+        last_state_ = std::move(state);
+
+        finish_parse_stats(std::move(parse_stats_), tokens.stats_flag_found(), last_state_.args_.size());
+    }
+
+    const ParseState& ArgumentParser::parse_state() const { return last_state_; }
+
+    ArgumentParser& ArgumentParser::record_parse_state(bool enable) {
+        record_parse_state_ = enable;
+        for (auto& subcommand : subcommands_) {
+            if (subcommand.parser) {
+                subcommand.parser->record_parse_state(enable);
+            }
+        }
+        return *this;
+    }
+
+    bool ArgumentParser::has_chunked_arguments() const {
+        for (const auto& hot : argument_table_->hot_table()) {
+            if (hot.has(ArgumentHot::CHUNKED)) return true;
+        }
+        return false;
+    }
+
+    bool ArgumentParser::parse_events(int argc, const char* const* argv, ParseHandler& handler) {
+        ArgvTokenSource tokens(argc, argv);
+        return parse_events(tokens, handler);
+    }
+
+    bool ArgumentParser::parse_events(std::vector<std::string> arg_strs, ParseHandler& handler) {
+        VectorTokenSource tokens(std::move(arg_strs));
+        return parse_events(tokens, handler);
+    }
+
+    bool ArgumentParser::parse_events(TokenSource& source, ParseHandler& handler) {
+        //Nothing but the statistics of a parse is kept on the parser, so if they are not
+        //kept either the parses of a frozen parser may run concurrently
+        bool keep_stats = !frozen();
+        std::unique_ptr<ParseStats> stats = start_parse_stats();
+
+        ParseTokenSource tokens(source, parse_stats_flag_, nullptr);
+        try {
+            resolve_events(tokens, handler, stats.get());
+        } catch (const ArgParseError& e) {
+            if (keep_stats) parse_stats_ = std::move(stats);
+            handler.on_error(e);
+            return false;
+        }
+        handler.on_end();
+
+        finish_parse_stats(std::move(stats), tokens.stats_flag_found(), tokens.num_tokens(), keep_stats);
+        return true;
+    }
+
+    ArgumentParser& ArgumentParser::freeze() {
+        if (frozen()) return *this;
+
         add_help_option_if_unspecified();
+        compile_constraints();
+        argument_table_->link_destinations_if_needed();
 
-        //Reset all the defaults
-        for (const auto& group : argument_groups()) {
-            for (const auto& arg : group.arguments()) {
-                if (arg->default_set()) {
-                    arg->set_dest_to_default();
-                }
+        //Build the (otherwise lazily built) index used to suggest option strings
+        OptionTable options;
+        build_option_table(options);
+        suggest_options(std::string(), options.str_to_option_arg);
+
+        for (size_t i = 0; i < subcommands_.size(); ++i) {
+            subparser_for(int(i)).freeze();
+        }
+
+        argument_table_->freeze();
+        return *this;
+    }
+
+    bool ArgumentParser::frozen() const { return argument_table_->frozen(); }
+
+    ArgumentParser& ArgumentParser::collect_parse_stats(bool enable, AllocationCounter allocation_counter) {
+        collect_parse_stats_ = enable;
+        allocation_counter_ = allocation_counter;
+        return *this;
+    }
+
+    ArgumentParser& ArgumentParser::parse_stats_flag(std::string flag) {
+        parse_stats_flag_ = flag;
+        return *this;
+    }
+
+    const ParseStats* ArgumentParser::parse_stats() const { return parse_stats_.get(); }
+
+    ArgumentParser& ArgumentParser::async_conversion_threads(size_t num_threads) {
+        async_conversion_threads_ = num_threads;
+        conversion_pool_.reset(); //Restarted with the new size when next required
+        return *this;
+    }
+
+    void ArgumentParser::print_parse_stats() {
+        if (!parse_stats_) {
+            os_ << "No parse statistics collected\n";
+            return;
+        }
+        print_parse_stats(*parse_stats_);
+    }
+
+    void ArgumentParser::print_parse_stats(const ParseStats& stats) {
+        auto us = [](ParseStats::Duration duration) {
+            return std::chrono::duration<double,std::micro>(duration).count();
+        };
+
+        const std::string indent = "  ";
+        std::stringstream ss;
+        ss << "parse statistics:\n";
+        ss << indent << "tokens: " << stats.num_tokens << "\n";
+        ss << indent << "conversions: " << stats.num_conversions << "\n";
+        if (stats.allocations_counted) {
+            ss << indent << "allocations: " << stats.num_allocations << "\n";
+        }
+        ss << indent << "table construction: " << us(stats.table_construction) << " us\n";
+        ss << indent << "token resolution: " << us(stats.token_resolution) << " us\n";
+        ss << indent << indent << "lookahead: " << us(stats.lookahead) << " us\n";
+        ss << indent << indent << "choice validation: " << us(stats.choice_validation) << " us\n";
+        ss << indent << "default application: " << us(stats.default_application) << " us\n";
+        ss << indent << "conversion: " << us(stats.conversion) << " us\n";
+
+        //Slowest converting arguments first
+        std::vector<ArgumentId> ids;
+        for (size_t id = 0; id < stats.argument_conversion.size(); ++id) {
+            if (stats.argument_conversions[id] > 0) {
+                ids.push_back(ArgumentId(id));
+            }
+        }
+        std::stable_sort(ids.begin(), ids.end(), [&](ArgumentId lhs, ArgumentId rhs) {
+            return stats.argument_conversion[lhs] > stats.argument_conversion[rhs];
+        });
+        ss << indent << "conversion by argument:\n";
+        for (ArgumentId id : ids) {
+            ss << indent << indent << argument_table_->argument(id).name() << ": " << us(stats.argument_conversion[id]) << " us";
+            ss << " (" << stats.argument_conversions[id] << " conversion" << (stats.argument_conversions[id] > 1 ? "s" : "") << ")\n";
+        }
+        os_ << ss.str();
+    }
+
+    std::unique_ptr<ParseStats> ArgumentParser::start_parse_stats() {
+        //The statistics flag may be anywhere on the command-line, so statistics are also
+        //collected if it is set (and discarded by finish_parse_stats() if it was not specified)
+        if (!collect_parse_stats_ && parse_stats_flag_.empty()) {
+            return nullptr;
+        }
+
+        add_help_option_if_unspecified(); //So all arguments are counted
+
+        std::unique_ptr<ParseStats> stats(new ParseStats());
+        stats->argument_conversion.resize(argument_table_->size());
+        stats->argument_conversions.resize(argument_table_->size());
+        if (allocation_counter_) {
+            stats->allocations_counted = true;
+            stats->num_allocations = allocation_counter_();
+        }
+        return stats;
+    }
+
+    void ArgumentParser::finish_parse_stats(std::unique_ptr<ParseStats> stats, bool print_stats, size_t num_tokens, bool keep) {
+        if (stats && (collect_parse_stats_ || print_stats)) {
+            stats->num_tokens = num_tokens;
+            if (stats->allocations_counted) {
+                stats->num_allocations = allocation_counter_() - stats->num_allocations;
+            }
+
+            if (print_stats) {
+                print_parse_stats(*stats);
+            }
+        } else {
+            stats.reset();
+        }
+
+        if (keep) {
+            parse_stats_ = std::move(stats);
+        }
+    }
+
+    void ArgumentParser::resolve_args(TokenSource& tokens, ParseState& state) {
+        add_help_option_if_unspecified();
+
+        state.num_arguments_ = argument_table_->size();
+
+        StateBuilder builder(*this, &state);
+        state.subcommand_ = resolve_tokens(tokens, builder, parse_stats_.get());
+        builder.finish();
+        if (state.subcommand_ >= 0) {
+            state.subcommand_args_ = tokens.position();
+
+            //The remaining arguments are parsed by the sub-command (see apply_args())
+            while (tokens.peek()) {
+                tokens.skip();
             }
         }
+    }
+
+    void ArgumentParser::stream_args(TokenSource& tokens) {
+        add_help_option_if_unspecified();
+        selected_subcommand_ = -1;
+
+        apply_defaults(std::vector<bool>(argument_table_->size(), true), false);
+
+        StateBuilder builder(*this, nullptr);
+        int subcommand = resolve_tokens(tokens, builder, parse_stats_.get());
+        builder.finish();
+
+        if (subcommand >= 0) {
+            //The sub-command's parser reads the rest of the command-line
+            selected_subcommand_ = subcommand;
+            subparser_for(subcommand).parse_args_throw(tokens);
+        }
+
+        check_required(builder.specified_arguments(), subcommand >= 0);
+    }
+
+    void ArgumentParser::resolve_events(TokenSource& tokens, ParseHandler& handler, ParseStats* stats) {
+        add_help_option_if_unspecified();
+
+        RequiredTracker tracker(handler, argument_table_->size());
+        int subcommand = resolve_tokens(tokens, tracker, stats);
+        if (subcommand >= 0) {
+            //The sub-command's arguments are not counted in stats, which are indexed by this parser's arguments
+            subparser_for(subcommand).resolve_events(tokens, handler, nullptr);
+        }
+
+        check_required(tracker.specified_arguments(), subcommand >= 0);
+    }
+
+    int ArgumentParser::resolve_tokens(TokenSource& tokens, ParseHandler& handler, ParseStats* stats) {
+        add_help_option_if_unspecified();
+        compile_constraints();
 
         //Create a look-up of expected argument strings and positional arguments
-        std::map<std::string,std::shared_ptr<Argument>> str_to_option_arg;
-        std::list<std::shared_ptr<Argument>> positional_args;
-        for (const auto& group : argument_groups()) {
-            for (const auto& arg : group.arguments()) {
-                if (arg->positional()) {
-                    positional_args.push_back(arg);
-                } else {
-                    for (const auto& opt : {arg->long_option(), arg->short_option()}) {
-                        if (opt.empty()) continue;
+        OptionTable options;
+        {
+            ScopedTimer timer(stats ? &stats->table_construction : nullptr);
+            build_option_table(options);
+        }
 
-                        auto ret = str_to_option_arg.insert(std::make_pair(opt, arg));
+        ParserArguments args(*this);
+        HandlerTokenResolver resolver(*this, args, options, handler);
+        return resolver.resolve(tokens, stats);
+    }
 
-                        if (!ret.second) {
-                            //Option string already specified
-                            std::stringstream ss;
-                            ss << "Option string '" << opt << "' maps to multiple options";
-                            throw ArgParseError(ss.str());
-                        }
+    void ArgumentParser::build_option_table(OptionTable& options) const {
+        for (size_t id = 0; id < argument_table_->size(); ++id) {
+            const ArgumentCold& cold = argument_table_->cold(ArgumentId(id));
+            options.add(ArgumentId(id), argument_table_->hot(ArgumentId(id)).has(ArgumentHot::POSITIONAL), *cold.long_opt, *cold.short_opt);
+        }
+    }
+
+    void ArgumentParser::apply_args(const ParseState& state, const ParseState* previous) {
+        selected_subcommand_ = -1;
+
+        std::vector<std::vector<size_t>> occurrences_by_arg = state.occurrences_by_argument();
+
+        std::vector<bool> changed_args(state.num_arguments_, true);
+        if (previous) {
+            std::vector<std::vector<size_t>> prev_occurrences_by_arg = previous->occurrences_by_argument();
+
+            for (size_t id = 0; id < state.num_arguments_; ++id) {
+                changed_args[id] = !state.same_occurrences(occurrences_by_arg[id], *previous, prev_occurrences_by_arg[id]);
+            }
+
+            //Arguments sharing a destination interact through it (e.g. the later one wins),
+            //so if any such argument changed fall back to applying everything in command-line order
+            argument_table_->link_destinations_if_needed();
+            for (size_t id = 0; id < state.num_arguments_; ++id) {
+                if (changed_args[id] && argument_table_->cold(ArgumentId(id)).next_same_dest != id) {
+                    reset_destinations();
+                    previous = nullptr;
+                    changed_args.assign(state.num_arguments_, true);
+                    break;
+                }
+            }
+        }
+
+        //Reset all the defaults (of changed arguments)
+        apply_defaults(changed_args, previous != nullptr);
+
+        //Set the specified values (of changed arguments), in command-line order
+        {
+            ScopedTimer timer(parse_stats_ ? &parse_stats_->conversion : nullptr);
+            std::vector<PendingStore> pending_stores;
+            ConversionFailure failure;
+            for (const auto& occurrence : state.occurrences_) {
+                if (changed_args[occurrence.arg]) {
+                    ScopedTimer arg_timer(parse_stats_ ? &parse_stats_->argument_conversion[occurrence.arg] : nullptr);
+                    if (parse_stats_) {
+                        parse_stats_->argument_conversions[occurrence.arg] += occurrence.num_values();
+                        parse_stats_->num_conversions += occurrence.num_values();
                     }
+                    apply_occurrence(state, occurrence, &pending_stores, failure);
+                    if (failure.failed()) break; //Any later failure would be reported after it
                 }
             }
+
+            //Complete the asynchronous conversions (which ran while the others were applied).
+            //The earliest error on the command-line is reported, whether it was asynchronous or not
+            finish_pending_stores(pending_stores, failure);
         }
 
-        std::set<std::shared_ptr<Argument>> specified_arguments;
+        if (previous && previous->subcommand_ >= 0 && previous->subcommand_ != state.subcommand_) {
+            //No longer selected
+            subcommands_[previous->subcommand_].parser->reset_destinations();
+        }
+
+        if (state.subcommand_ >= 0) {
+            selected_subcommand_ = state.subcommand_;
+            ArgumentParser& subparser = subparser_for(state.subcommand_);
+
+            std::vector<std::string> subcommand_args(state.args_.begin() + state.subcommand_args_, state.args_.end());
+            if (previous && previous->subcommand_ == state.subcommand_) {
+                //The sub-command's parser tracks its own previous state
+                subparser.reparse_args_throw(subparser.parse_state(), std::move(subcommand_args));
+            } else {
+                subparser.parse_args_throw(std::move(subcommand_args));
+            }
+        }
+    }
 
-        //Process the arguments
-        for (size_t i = 0; i < arg_strs.size(); i++) {
-            ShortArgInfo short_arg_info = no_space_short_arg(arg_strs[i], str_to_option_arg);
+    void ArgumentParser::apply_defaults(const std::vector<bool>& changed_args, bool reset) {
+        ScopedTimer timer(parse_stats_ ? &parse_stats_->default_application : nullptr);
+        for (size_t id = 0; id < changed_args.size(); ++id) {
+            if (!changed_args[id]) continue;
 
-            std::shared_ptr<Argument> arg;
+            Argument& arg = argument_table_->argument(ArgumentId(id));
+            if (arg.is_chunked()) continue; //Set while resolving
 
-            if (short_arg_info.is_no_space_short_arg) {
-                //Short argument with no space between value
-                arg = short_arg_info.arg;
-            } else { //Full argument
-                auto iter = str_to_option_arg.find(arg_strs[i]);
-                if (iter != str_to_option_arg.end()) {
-                    arg = iter->second;
+            if (reset) {
+                arg.reset_dest();
+            }
+            if (argument_table_->hot(ArgumentId(id)).has(ArgumentHot::DEFAULT_SET)) {
+                ScopedTimer arg_timer(parse_stats_ ? &parse_stats_->argument_conversion[id] : nullptr);
+                if (parse_stats_) {
+                    ++parse_stats_->argument_conversions[id];
+                    ++parse_stats_->num_conversions;
                 }
+                arg.set_dest_to_default();
             }
+        }
+    }
 
-            if (arg) {
-                //Start of an argument
-
-                specified_arguments.insert(arg);
+    void ArgumentParser::apply_occurrence(const ParseState& state, const ParseState::Occurrence& occurrence,
+                                          std::vector<PendingStore>* pending_stores, ConversionFailure& failure) {
+        const ArgumentHot& hot = argument_table_->hot(occurrence.arg);
+        Argument& arg = argument_table_->argument(occurrence.arg);
 
-                if (arg->action() == Action::STORE_TRUE) {
-                    arg->set_dest_to_true(); 
-                } else if (arg->action() == Action::STORE_FALSE) {
-                    arg->set_dest_to_false();
-                } else if (arg->action() == Action::HELP) {
-                    arg->set_dest_to_true(); 
-                    throw ArgParseHelp();
-                } else if (arg->action() == Action::VERSION) {
-                    arg->set_dest_to_true(); 
-                    throw ArgParseVersion();
-                } else {
-                    assert(arg->action() == Action::STORE);
-
-
-                    size_t max_values_to_read = 0;
-                    size_t min_values_to_read = 0;
-                    if (arg->nargs() == '1') {
-                        max_values_to_read = 1;
-                        min_values_to_read = 1;
-                    } else if (arg->nargs() == '?') {
-                        max_values_to_read = 1;
-                        min_values_to_read = 0;
-                    } else if (arg->nargs() == '*') {
-                        max_values_to_read = std::numeric_limits<size_t>::max();
-                        min_values_to_read = 0;
+        if (hot.action == Action::STORE_TRUE) {
+            arg.set_dest_to_true(); 
+        } else if (hot.action == Action::STORE_FALSE) {
+            arg.set_dest_to_false();
+        } else {
+            assert(hot.action == Action::STORE);
+            assert(hot.has(ArgumentHot::POSITIONAL) || hot.nargs != '1' || occurrence.num_values() == 1);
+
+            //Set the values appropriately (ordered by their index in args_)
+            for (size_t i = occurrence.first; i < occurrence.last; ++i) {
+                try {
+                    if (i == occurrence.first && occurrence.offset != 0) {
+                        //Attached to its short option
+                        store_value(arg, state.args_[i].substr(occurrence.offset), pending_stores, i);
                     } else {
-                        assert (arg->nargs() == '+');
-                        max_values_to_read = std::numeric_limits<size_t>::max();
-                        min_values_to_read = 1;
+                        store_value(arg, state.args_[i], pending_stores, i);
                     }
+                } catch (const ArgParseConversionError& e) {
+                    failure.record(*this, arg, i, e);
+                    return;
+                }
+            }
+        }
+    }
 
-                    std::vector<std::string> values;
-                    size_t nargs_read = 0;
-                    if (short_arg_info.is_no_space_short_arg) {
-                        //It is a short argument, we already have the first value
-                        if (!short_arg_info.value.empty()) {
-                            values.push_back(short_arg_info.value);
-                            ++nargs_read;
-                        }
-                    }
-                    for (; nargs_read < max_values_to_read; ++nargs_read) {
-                        size_t next_idx = i + 1 + nargs_read;
-                        if (next_idx >= arg_strs.size()) {
-                            break;
-                        }
-                        std::string str = arg_strs[next_idx];
+    void ArgumentParser::apply_positional_value(Argument& arg, const std::string& value) {
+        try {
+            store_value(arg, value, nullptr, 0);
+        } catch (const ArgParseConversionError& e) {
+            throw annotate_conversion_error(arg, e);
+        }
+    }
 
+    void ArgumentParser::store_value(Argument& arg, const std::string& value, std::vector<PendingStore>* pending_stores, size_t order) {
+        const ArgumentHot& hot = argument_table_->hot(arg.id());
+        const ValueOps& ops = arg.value_ops();
+        bool multi = (hot.nargs != '1' || hot.delimiter);
+
+        if (pending_stores && ops.start_store_value
+            && !hot.delimiter //Delimited fields are converted immediately
+            && multi == (ops.kind == ValueOps::Kind::MULTI)) {
+            arg.value_changed();
+            pending_stores->push_back({&arg, ops.start_store_value(arg, arg.destination(), value, conversion_pool()), order});
+        } else if (multi) {
+            //Multiple values, or a delimited list
+            arg.add_value_to_dest(value);
+        } else {
+            arg.set_dest_to_value(value);
+        }
+    }
 
-                        if (is_argument(str, str_to_option_arg)) break;
+    void ArgumentParser::finish_pending_stores(std::vector<PendingStore>& pending_stores, ConversionFailure& failure) {
+        //All the conversions are waited for (even after an error), as they refer to the destinations
+        for (auto& pending_store : pending_stores) {
+            try {
+                pending_store.finish();
+            } catch (const ArgParseConversionError& e) {
+                failure.record(*this, *pending_store.arg, pending_store.order, e);
+            }
+        }
+        pending_stores.clear();
 
-                        if (!arg->is_valid_value(str)) break;
+        if (failure.failed()) {
+            throw ArgParseConversionError(failure.message);
+        }
+    }
 
-                        values.push_back(str);
-                    }
+    void ArgumentParser::ConversionFailure::record(const ArgumentParser& parser, const Argument& arg, size_t value_order, const ArgParseConversionError& e) {
+        if (value_order < order) {
+            order = value_order;
+            message = parser.annotate_conversion_error(arg, e).what();
+        }
+    }
 
-                    if (nargs_read < min_values_to_read) {
+    ArgParseConversionError ArgumentParser::annotate_conversion_error(const Argument& arg, const ArgParseConversionError& e) const {
+        std::stringstream msg;
+        if (arg.positional()) {
+            msg << e.what() << " for positional argument " << arg.long_option();
+        } else {
+            msg << e.what() << " for " << arg.long_option();
+            auto short_opt = arg.short_option();
+            if (!short_opt.empty()) {
+                msg << "/" << short_opt;
+            }
+        }
+        return ArgParseConversionError(msg.str());
+    }
 
-                        if (arg->nargs() == '1') {
-                            std::stringstream msg;
-                            msg << "Missing expected argument for " << arg_strs[i] << "";
-                            throw ArgParseError(msg.str());
+    ThreadPool& ArgumentParser::conversion_pool() {
+        if (!conversion_pool_) {
+            size_t num_threads = async_conversion_threads_;
+            if (num_threads == 0) {
+                num_threads = std::thread::hardware_concurrency();
+            }
+            conversion_pool_.reset(new ThreadPool(num_threads));
+        }
+        return *conversion_pool_;
+    }
 
-                        } else {
-                            std::stringstream msg;
-                            msg << "Expected at least " << min_values_to_read << " value";
-                            if (min_values_to_read > 1) {
-                                msg << "s";
-                            }
-                            msg << " for argument '" << arg_strs[i] << "'";
-                            msg << " (found " << values.size() << ")";
-                            throw ArgParseError(msg.str());
-                        }
-                    }
-                    assert (nargs_read <= max_values_to_read);
-
-                    for (const auto& val : values) {
-                        if (!is_valid_choice(val, arg->choices())) {
-                            std::stringstream msg;
-                            msg << "Unexpected option value '" << values[0] << "' (expected one of: " << join(arg->choices(), ", ");
-                            msg << ") for " << arg->name();
-                            throw ArgParseError(msg.str());
-                        }
-                    }
+    void ArgumentParser::check_required(const ParseState& state) const {
+        std::vector<bool> specified_arguments(state.num_arguments_, false);
+        for (const auto& occurrence : state.occurrences_) {
+            specified_arguments[occurrence.arg] = true;
+        }
 
-                    //Set the option values appropriately
-                    if (arg->nargs() == '1') {
-                        assert(nargs_read == 1);
-                        assert(values.size() == 1);
-
-
-                        try {
-                            arg->set_dest_to_value(values[0]); 
-                        } catch (const ArgParseConversionError& e) {
-                            std::stringstream msg;
-                            msg << e.what() << " for " << arg->long_option();
-                            auto short_opt = arg->short_option();
-                            if (!short_opt.empty()) {
-                                msg << "/" << short_opt;
-                            }
-                            throw ArgParseConversionError(msg.str());
-                        }
-                    } else if (arg->nargs() == '+' || arg->nargs() == '*') {
-                        if (arg->nargs() == '+') {
-                            assert(nargs_read >= 1);
-                            assert(values.size() >= 1);
-                        }
+        check_required(specified_arguments, state.subcommand_ >= 0);
+    }
 
-                        for (const auto& value : values) {
-                            try {
-                                arg->add_value_to_dest(value); 
-                            } catch (const ArgParseConversionError& e) {
-                                std::stringstream msg;
-                                msg << e.what() << " for " << arg->long_option();
-                                auto short_opt = arg->short_option();
-                                if (!short_opt.empty()) {
-                                    msg << "/" << short_opt;
-                                }
-                                throw ArgParseConversionError(msg.str());
-                            }
-                        }
-                    } else {
-                        std::stringstream msg;
-                        msg << "Unsupport nargs value '" << arg->nargs() << "'";
-                        throw ArgParseError(msg.str());
-                    }
+    void ArgumentParser::check_required(const std::vector<bool>& specified_arguments, bool subcommand_selected) const {
+        check_required_arguments(ParserArguments(*this), specified_arguments, subcommand_selected);
 
-                    if (!short_arg_info.is_no_space_short_arg) {
-                        i += nargs_read; //Skip over the values (don't need to for short args)
-                    }
+        check_constraints(specified_arguments);
+    }
+
+    std::vector<ArgumentId> ArgumentParser::constraint_arguments(const std::vector<std::string>& names) const {
+        std::vector<ArgumentId> ids;
+        for (const auto& name : names) {
+            ArgumentId found = NO_ARGUMENT_ID;
+            for (size_t id = 0; id < argument_table_->size() && found == NO_ARGUMENT_ID; ++id) {
+                const ArgumentCold& cold = argument_table_->cold(ArgumentId(id));
+                if (*cold.long_opt == name || *cold.short_opt == name) {
+                    found = ArgumentId(id);
                 }
+            }
+            if (found == NO_ARGUMENT_ID) {
+                throw ArgParseError("Unknown argument '" + name + "' in constraint");
+            }
+            ids.push_back(found);
+        }
+        return ids;
+    }
 
-            } else {
-                if (positional_args.empty()) {
-                    //Unrecognized
-                    std::stringstream ss;
-                    ss << "Unexpected command-line argument '" << arg_strs[i] << "'";
-                    throw ArgParseError(ss.str());
-                } else {
-                    //Positional argument
-                    auto pos_arg = positional_args.front();
-                    positional_args.pop_front();
-
-                    try {
-                        pos_arg->set_dest_to_value(arg_strs[i]); 
-                    } catch (const ArgParseConversionError& e) {
-                        std::stringstream msg;
-                        msg << e.what() << " for positional argument " << pos_arg->long_option();
-                        throw ArgParseConversionError(msg.str());
+    void ArgumentParser::compile_constraints() {
+        const auto& constraints = argument_table_->constraints();
+        if (compiled_num_constraints_ == constraints.size() && compiled_num_arguments_ == argument_table_->size()) {
+            return; //Up to date
+        }
+
+        //The arguments were checked when each constraint was added, so only the masks (which
+        //depend on the number of arguments, and the arguments of groups) are built here
+        size_t num_words = (argument_table_->size() + 63) / 64;
+        std::vector<CompiledConstraint> compiled;
+        compiled.reserve(constraints.size());
+        for (const auto& constraint : constraints) {
+            CompiledConstraint compiled_constraint;
+            compiled_constraint.kind = constraint.kind;
+            compiled_constraint.arg = NO_ARGUMENT_ID;
+            compiled_constraint.mask.assign(num_words, 0);
+
+            std::vector<ArgumentId> ids;
+            if (constraint.group) {
+                for (const auto& group : argument_groups_) {
+                    if (&group.name() != constraint.group) continue;
+                    for (const Argument* arg : group.arguments()) {
+                        ids.push_back(arg->id());
                     }
+                }
+            } else {
+                ids = constraint.args;
+            }
+            for (ArgumentId id : ids) {
+                compiled_constraint.mask[id / 64] |= uint64_t(1) << (id % 64);
+            }
+            compiled_constraint.arg = constraint.arg;
+            compiled.push_back(std::move(compiled_constraint));
+        }
 
-                    auto value = arg_strs[i];
-                    specified_arguments.insert(pos_arg);
+        compiled_constraints_ = std::move(compiled);
+        compiled_num_constraints_ = constraints.size();
+        compiled_num_arguments_ = argument_table_->size();
+    }
+
+    void ArgumentParser::check_constraints(const std::vector<bool>& specified_arguments) const {
+        if (compiled_constraints_.empty()) return;
+
+        std::vector<uint64_t> specified((specified_arguments.size() + 63) / 64, 0);
+        for (size_t id = 0; id < specified_arguments.size(); ++id) {
+            if (specified_arguments[id]) {
+                specified[id / 64] |= uint64_t(1) << (id % 64);
+            }
+        }
+
+        //Returns the names of the arguments in mask
+        auto names = [&](const std::vector<uint64_t>& mask) {
+            std::vector<std::string> arg_names;
+            for (size_t word = 0; word < mask.size(); ++word) {
+                for (uint64_t bits = mask[word]; bits; bits &= bits - 1) {
+                    size_t id = word * 64 + size_t(__builtin_ctzll(bits));
+                    arg_names.push_back(argument_table_->argument(ArgumentId(id)).name());
                 }
             }
+            return arg_names;
+        };
+
+        std::vector<std::string> violations;
+        std::vector<uint64_t> selected(specified.size());
+        for (const auto& constraint : compiled_constraints_) {
+            size_t num_selected = 0;
+            for (size_t word = 0; word < specified.size(); ++word) {
+                if (constraint.kind == ArgumentConstraint::Kind::REQUIRES) {
+                    selected[word] = constraint.mask[word] & ~specified[word]; //Missing
+                } else {
+                    selected[word] = constraint.mask[word] & specified[word]; //Specified
+                }
+                num_selected += size_t(__builtin_popcountll(selected[word]));
+            }
+
+            if (constraint.kind == ArgumentConstraint::Kind::MUTUALLY_EXCLUSIVE && num_selected > 1) {
+                violations.push_back("Mutually exclusive arguments specified: " + join(names(selected), ", "));
+            } else if (constraint.kind == ArgumentConstraint::Kind::REQUIRES && num_selected > 0
+                       && specified_arguments[constraint.arg]) {
+                violations.push_back("Argument " + argument_table_->argument(constraint.arg).name() + " requires: " + join(names(selected), ", "));
+            } else if (constraint.kind == ArgumentConstraint::Kind::AT_LEAST_ONE && num_selected == 0) {
+                violations.push_back("Expected at least one of: " + join(names(constraint.mask), ", "));
+            }
         }
 
-        //Missing positionals?
-        for(const auto& remaining_positional : positional_args) {
-            std::stringstream ss;
-            ss << "Missing required positional argument: " << remaining_positional->long_option();
-            throw ArgParseError(ss.str());
+        if (!violations.empty()) {
+            throw ArgParseError(join(violations, "; "));
         }
+    }
 
-        //Missing required?
-        for (const auto& group : argument_groups()) {
-            for (const auto& arg : group.arguments()) {
-                if (arg->required()) {
-                    //potentially slow...
-                    if (!specified_arguments.count(arg)) {
-                        std::stringstream msg;
-                        msg << "Missing required argument: " << arg->long_option();
-                        auto short_opt = arg->short_option();
-                        if (!short_opt.empty()) {
-                            msg << "/" << short_opt;
-                        }
-                        throw ArgParseError(msg.str());
+    void ArgumentParser::reset_destinations() {
+        ++parse_generation_;
+        for (size_t id = 0; id < argument_table_->size(); ++id) {
+            argument_table_->argument(ArgumentId(id)).reset_dest();
+        }
+        for (const auto& subcommand : subcommands_) {
+            if (subcommand.parser) {
+                subcommand.parser->reset_destinations();
+            }
+        }
+    }
+
+    //Identifies (and versions) the parse cache file format
+    constexpr char PARSE_CACHE_MAGIC[8] = {'A', 'R', 'G', 'P', 'C', 'A', 'C', '1'};
+
+    std::string ArgumentParser::parse_cache_file(uint64_t parser_fingerprint, const std::vector<std::string>& arg_strs) const {
+        Fnv1aHash hash;
+        hash.add_value(parser_fingerprint);
+        hash.add_value<uint64_t>(arg_strs.size());
+        for (const auto& arg_str : arg_strs) {
+            hash.add(arg_str);
+        }
+
+        std::stringstream ss;
+        ss << parse_cache_dir_ << "/argparse-" << std::hex << hash.value() << ".cache";
+        return ss.str();
+    }
+
+    bool ArgumentParser::load_cached_parse(const std::vector<std::string>& arg_strs) {
+        uint64_t parser_fingerprint = fingerprint();
+        MappedFile file(parse_cache_file(parser_fingerprint, arg_strs));
+        if (!file.valid()) {
+            return false;
+        }
+
+        const char* data = file.data();
+        const char* end = file.data() + file.size();
+
+        //Header, which must match exactly (the file name is only a hash)
+        std::string expected_header(PARSE_CACHE_MAGIC, sizeof(PARSE_CACHE_MAGIC));
+        ValueSerializer<uint64_t>::write(parser_fingerprint, expected_header);
+        ValueSerializer<std::vector<std::string>>::write(arg_strs, expected_header);
+        if (file.size() < expected_header.size()
+            || std::memcmp(data, expected_header.data(), expected_header.size()) != 0) {
+            return false;
+        }
+        data += expected_header.size();
+        const char* values_begin = data;
+
+        //Check all the values are well formed before modifying any destinations
+        for (int apply = 0; apply < 2; ++apply) {
+            data = values_begin;
+
+            uint64_t num_values = 0;
+            if (!ValueSerializer<uint64_t>::read(data, end, num_values)) return false;
+
+            for (uint64_t i = 0; i < num_values; ++i) {
+                ArgumentId id = NO_ARGUMENT_ID;
+                if (!ValueSerializer<ArgumentId>::read(data, end, id)) return false;
+                if (id >= argument_table_->size()) return false;
+
+                Argument& arg = argument_table_->argument(id);
+                const ValueOps& ops = arg.value_ops();
+                if (!ops.deserialize) return false;
+
+                if (!ops.deserialize(apply ? arg.destination() : nullptr, data, end)) return false;
+            }
+            if (data != end) return false;
+        }
+
+        //The destinations no longer reflect the last parse state
+        ++parse_generation_;
+        selected_subcommand_ = -1;
+        invalidate_value_fingerprints();
+
+        return true;
+    }
+
+    void ArgumentParser::store_cached_parse(const ParseState& state) const {
+        if (state.subcommand_ >= 0) {
+            return; //The sub-command's destinations are not cached
+        }
+
+        //The destinations set by the parse: those with defaults, and those specified
+        std::vector<bool> set_args(argument_table_->size(), false);
+        for (size_t id = 0; id < argument_table_->size(); ++id) {
+            set_args[id] = argument_table_->hot(ArgumentId(id)).has(ArgumentHot::DEFAULT_SET);
+        }
+        for (const auto& occurrence : state.occurrences_) {
+            set_args[occurrence.arg] = true;
+        }
+
+        std::string values;
+        uint64_t num_values = 0;
+        std::vector<const void*> saved_dests;
+        for (size_t id = 0; id < argument_table_->size(); ++id) {
+            if (!set_args[id]) continue;
+
+            const Argument& arg = argument_table_->argument(ArgumentId(id));
+            if (std::find(saved_dests.begin(), saved_dests.end(), arg.destination()) != saved_dests.end()) {
+                continue; //Shared destination already saved
+            }
+
+            const ValueOps& ops = arg.value_ops();
+            if (!ops.serialize) {
+                return; //Can not be cached
+            }
+
+            ValueSerializer<ArgumentId>::write(ArgumentId(id), values);
+            ops.serialize(arg.destination(), values);
+            saved_dests.push_back(arg.destination());
+            ++num_values;
+        }
+
+        uint64_t parser_fingerprint = fingerprint();
+        std::string contents(PARSE_CACHE_MAGIC, sizeof(PARSE_CACHE_MAGIC));
+        ValueSerializer<uint64_t>::write(parser_fingerprint, contents);
+        ValueSerializer<std::vector<std::string>>::write(state.args_, contents);
+        ValueSerializer<uint64_t>::write(num_values, contents);
+        contents += values;
+
+        //The cache is only an optimization, so failing to write it is not an error
+        write_file_atomic(parse_cache_file(parser_fingerprint, state.args_), contents);
+    }
+
+    CommandLine ArgumentParser::serialize_args(const std::string& program) const {
+        CommandLine cmd_line;
+        cmd_line.reserve(2 * argument_table_->size() + 1, 16 * argument_table_->size() + program.size() + 1);
+        cmd_line.push_back(program);
+        append_specified_args(cmd_line);
+        return cmd_line;
+    }
+
+    void ArgumentParser::append_specified_args(CommandLine& cmd_line) const {
+        //Values which would be re-parsed as options can not be serialized
+        OptionTable options;
+        build_option_table(options);
+
+        //Positional arguments first, since options with multiple values would otherwise consume them
+        bool multi_value_last = false; //Whether the last option takes multiple values
+        for (bool positionals : {true, false}) {
+            for (size_t id = 0; id < argument_table_->size(); ++id) {
+                const ArgumentHot& hot = argument_table_->hot(ArgumentId(id));
+                if (hot.has(ArgumentHot::POSITIONAL) != positionals) continue;
+
+                const Argument& arg = argument_table_->argument(ArgumentId(id));
+                const ValueOps& ops = arg.value_ops();
+
+                //Only the argument which specified a (possibly shared) destination writes it
+                if (ops.specified_by(arg.destination()) != ArgumentId(id)) continue;
+
+                if (hot.action == Action::HELP || hot.action == Action::VERSION) {
+                    continue;
+                } else if (hot.action == Action::STORE_TRUE || hot.action == Action::STORE_FALSE) {
+                    cmd_line.push_back(arg.long_option());
+                    multi_value_last = false;
+                    continue;
+                }
+
+                if (!ops.append_strs) {
+                    throw ArgParseError("Converter for " + arg.name() + " has no to_str() to serialize its value");
+                }
+
+                if (!positionals) {
+                    cmd_line.push_back(arg.long_option());
+                    multi_value_last = (hot.nargs != '1');
+                }
+                size_t first_value = cmd_line.size();
+                try {
+                    ops.append_strs(arg.destination(), cmd_line);
+                } catch (const ArgParseConversionError& e) {
+                    throw ArgParseConversionError(std::string(e.what()) + " for " + arg.name());
+                }
+
+                for (size_t i = first_value; i < cmd_line.size(); ++i) {
+                    std::string value = cmd_line[i];
+                    if (value == END_OF_OPTIONS || is_argument(value, options.str_to_option_arg, options.short_options)) {
+                        throw ArgParseError("Can not serialize the value '" + value + "' of " + arg.name() + ", which would be parsed as an option");
                     }
                 }
             }
         }
+
+        const ArgumentParser* subparser = selected_subparser();
+        if (subparser) {
+            if (multi_value_last) {
+                //Otherwise the sub-command would be taken as one of the option's values
+                cmd_line.push_back(END_OF_OPTIONS);
+            }
+            cmd_line.push_back(subcommands_[selected_subcommand_].name);
+            subparser->append_specified_args(cmd_line);
+        }
     }
 
-    void ArgumentParser::reset_destinations() {
-        for (const auto& group : argument_groups()) {
-            for (const auto& arg : group.arguments()) {
-                arg->reset_dest();
+    Snapshot ArgumentParser::snapshot() const {
+        Snapshot snap;
+        snap.parser_ = this;
+        snap.num_arguments_ = argument_table_->size();
+        snap.parse_state_ = last_state_;
+        snap.parse_state_current_ = last_state_.parser_ == this && last_state_.generation_ == parse_generation_;
+        snap.selected_subcommand_ = selected_subcommand_;
+
+        //Distinct destinations in address order, so adjacent ones can be grouped
+        std::vector<const Argument*> args;
+        for (size_t id = 0; id < argument_table_->size(); ++id) {
+            args.push_back(&argument_table_->argument(ArgumentId(id)));
+        }
+        std::sort(args.begin(), args.end(), [](const Argument* lhs, const Argument* rhs) {
+            return std::less<const void*>()(lhs->destination(), rhs->destination());
+        });
+        args.erase(std::unique(args.begin(), args.end(), [](const Argument* lhs, const Argument* rhs) {
+            return lhs->destination() == rhs->destination();
+        }), args.end());
+
+        //Lay out the buffer
+        std::vector<Snapshot::Object> objects;
+        size_t offset = 0;
+        bool extend_run = false;
+        for (const Argument* arg : args) {
+            const ValueOps& ops = arg->value_ops();
+            void* dest = const_cast<void*>(arg->destination());
+
+            if (ops.trivially_copyable) {
+                if (extend_run && static_cast<char*>(snap.runs_.back().dest) + snap.runs_.back().size == dest) {
+                    snap.runs_.back().size += ops.size;
+                } else {
+                    snap.runs_.push_back({dest, offset, ops.size});
+                }
+                offset += ops.size;
+                extend_run = true;
+            } else {
+                offset = (offset + ops.alignment - 1) / ops.alignment * ops.alignment;
+                objects.push_back({dest, offset, &ops});
+                offset += ops.size;
+                extend_run = false;
+            }
+        }
+
+        //Copy the values
+        snap.buffer_.reset(new char[offset]);
+        snap.size_ = offset;
+        for (const auto& run : snap.runs_) {
+            std::memcpy(snap.buffer_.get() + run.offset, run.dest, run.size);
+        }
+        for (const auto& object : objects) {
+            object.ops->save(snap.buffer_.get() + object.offset, object.dest);
+            snap.objects_.push_back(object); //Only once constructed, so it is destroyed with snap
+        }
+
+        for (size_t i = 0; i < subcommands_.size(); ++i) {
+            if (subcommands_[i].parser) {
+                snap.subcommands_.push_back(int(i));
+                snap.subcommand_snapshots_.emplace_back(new Snapshot(subcommands_[i].parser->snapshot()));
+            }
+        }
+
+        return snap;
+    }
+
+    void ArgumentParser::restore(const Snapshot& snap) {
+        if (snap.parser_ != this || snap.num_arguments_ != argument_table_->size()) {
+            throw ArgParseError("Snapshot does not match the parser's arguments");
+        }
+
+        for (const auto& run : snap.runs_) {
+            std::memcpy(run.dest, snap.buffer_.get() + run.offset, run.size);
+        }
+        for (const auto& object : snap.objects_) {
+            object.ops->load(object.dest, snap.buffer_.get() + object.offset);
+        }
+        invalidate_value_fingerprints();
+
+        ++parse_generation_;
+        selected_subcommand_ = snap.selected_subcommand_;
+        last_state_ = snap.parse_state_;
+        if (snap.parse_state_current_) {
+            //The destinations are as left by the last parse again
+            last_state_.generation_ = parse_generation_;
+        }
+
+        for (size_t i = 0; i < subcommands_.size(); ++i) {
+            if (!subcommands_[i].parser) continue;
+
+            auto iter = std::find(snap.subcommands_.begin(), snap.subcommands_.end(), int(i));
+            if (iter != snap.subcommands_.end()) {
+                subcommands_[i].parser->restore(*snap.subcommand_snapshots_[iter - snap.subcommands_.begin()]);
+            } else {
+                //Constructed after the snapshot
+                subcommands_[i].parser->reset_destinations();
             }
         }
     }
@@ -347,19 +1405,156 @@ namespace argparse {
 
     std::string ArgumentParser::prog() const { return prog_; }
     std::string ArgumentParser::version() const { return version_; }
-    std::string ArgumentParser::description() const { return description_; }
-    std::string ArgumentParser::epilog() const { return epilog_; }
-    std::vector<ArgumentGroup> ArgumentParser::argument_groups() const { return argument_groups_; }
+    std::string ArgumentParser::description() const { return description_.str(); }
+    std::string ArgumentParser::epilog() const { return epilog_.str(); }
+    const std::vector<ArgumentGroup>& ArgumentParser::argument_groups() const { return argument_groups_; }
+
+    const Argument& ArgumentParser::argument(ArgumentId id) const { return argument_table_->argument(id); }
+
+    std::vector<std::string> ArgumentParser::subcommands() const {
+        std::vector<std::string> names;
+        for (const auto& subcommand : subcommands_) {
+            names.push_back(subcommand.name);
+        }
+        return names;
+    }
+
+    std::string ArgumentParser::subcommand_help(const std::string& name) const {
+        for (const auto& subcommand : subcommands_) {
+            if (subcommand.name == name) {
+                return subcommand.help;
+            }
+        }
+        throw ArgParseError("Unknown sub-command '" + name + "'");
+    }
+
+    std::string ArgumentParser::selected_subcommand() const {
+        if (selected_subcommand_ < 0) return "";
+        return subcommands_[selected_subcommand_].name;
+    }
+
+    ArgumentParser* ArgumentParser::selected_subparser() const {
+        if (selected_subcommand_ < 0) return nullptr;
+        return subcommands_[selected_subcommand_].parser.get();
+    }
+
+    ArgumentParser& ArgumentParser::active_parser() {
+        ArgumentParser* subparser = selected_subparser();
+        if (subparser) {
+            return subparser->active_parser();
+        }
+        return *this;
+    }
+
+    uint64_t ArgumentParser::config_fingerprint() const {
+        uint64_t hash = 0;
+        for (const auto& group : argument_groups_) {
+            hash += group.config_fingerprint();
+        }
+        return hash;
+    }
+
+    void ArgumentParser::invalidate_value_fingerprints() {
+        for (size_t id = 0; id < argument_table_->size(); ++id) {
+            argument_table_->cold(ArgumentId(id)).value_hash_valid = false;
+        }
+    }
+
+    uint64_t ArgumentParser::fingerprint() const {
+        Fnv1aHash hash;
+        hash.add_value<uint64_t>(argument_table_->size());
+        for (size_t id = 0; id < argument_table_->size(); ++id) {
+            const Argument& arg = argument_table_->argument(ArgumentId(id));
+            const ArgumentHot& hot = argument_table_->hot(ArgumentId(id));
+            const ArgumentCold& cold = argument_table_->cold(ArgumentId(id));
+
+            hash.add(*cold.long_opt);
+            hash.add(*cold.short_opt);
+            hash.add_value(hot.action);
+            hash.add_value(hot.nargs);
+            hash.add_value(hot.flags);
+            hash.add_value(hot.delimiter);
+
+            hash.add_value<uint64_t>(cold.default_value.size());
+            for (const auto& default_str : cold.default_value) {
+                hash.add(default_str);
+            }
+            hash.add_value<uint64_t>(cold.choices.size());
+            for (const auto& choice : cold.choices) {
+                hash.add(choice);
+            }
+
+            const ValueOps& ops = arg.value_ops();
+            hash.add(ops.value_type->name());
+            hash.add(ops.converter_type->name());
+        }
+
+        hash.add_value<uint64_t>(argument_table_->constraints().size());
+        for (const auto& constraint : argument_table_->constraints()) {
+            hash.add_value(constraint.kind);
+            hash.add_value(constraint.arg);
+            for (ArgumentId id : constraint.args) {
+                hash.add_value(id);
+            }
+            hash.add(constraint.group ? *constraint.group : std::string());
+        }
+
+        hash.add_value<uint64_t>(subcommands_.size());
+        for (const auto& subcommand : subcommands_) {
+            hash.add(subcommand.name);
+        }
+        hash.add_value(subcommand_required_);
+
+        return hash.value();
+    }
+
+    ParserSchema ArgumentParser::schema() {
+        add_help_option_if_unspecified(); //Accepted by the parser
+
+        std::vector<ArgumentSchema> arguments;
+        arguments.reserve(argument_table_->size());
+        for (size_t id = 0; id < argument_table_->size(); ++id) {
+            const Argument& arg = argument_table_->argument(ArgumentId(id));
+            const ArgumentHot& hot = argument_table_->hot(ArgumentId(id));
+            const ArgumentCold& cold = argument_table_->cold(ArgumentId(id));
+
+            ArgumentSchema arg_schema;
+            arg_schema.name = *cold.name;
+            arg_schema.long_opt = *cold.long_opt;
+            arg_schema.short_opt = *cold.short_opt;
+            arg_schema.group = *cold.group_name;
+            arg_schema.help = cold.help.str();
+            arg_schema.metavar = *cold.metavar;
+            arg_schema.type = arg.value_ops().schema_type();
+            arg_schema.action = hot.action;
+            arg_schema.nargs = hot.nargs;
+            arg_schema.delimiter = hot.delimiter;
+            arg_schema.choices = cold.choices;
+            arg_schema.default_value = cold.default_value;
+            arg_schema.required = hot.has(ArgumentHot::REQUIRED);
+            arg_schema.positional = hot.has(ArgumentHot::POSITIONAL);
+            arguments.push_back(std::move(arg_schema));
+        }
+
+        std::vector<ParserSchema::Subcommand> subcommands;
+        for (size_t i = 0; i < subcommands_.size(); ++i) {
+            ParserSchema::Subcommand subcommand;
+            subcommand.name = subcommands_[i].name;
+            subcommand.help = subcommands_[i].help;
+            subcommand.schema = std::make_shared<ParserSchema>(subparser_for(int(i)).schema());
+            subcommands.push_back(std::move(subcommand));
+        }
+
+        return ParserSchema(prog_, description_.str(), std::move(arguments), std::move(subcommands), subcommand_required_);
+    }
 
     void ArgumentParser::add_help_option_if_unspecified() {
         //Has a help already been specified
         bool found_help = false;
-        for(auto& grp : argument_groups_) {
-            for(auto& arg : grp.arguments()) {
-                if(arg->action() == Action::HELP) {
-                    found_help = true;
-                    break;
-                }
+        for (const auto& hot : argument_table_->hot_table()) {
+            if (hot.action == Action::HELP) {
+                found_help = true;
+                break;
             }
         }
 
@@ -373,83 +1568,170 @@ namespace argparse {
         }
     }
 
-    ArgumentParser::ShortArgInfo ArgumentParser::no_space_short_arg(std::string str, const std::map<std::string, std::shared_ptr<Argument>>& str_to_option_arg) const {
-
-        ShortArgInfo short_arg_info;
-        for(const auto& kv : str_to_option_arg) {
-            if (kv.first.size() == 2) {
-                //Is a short arg
-                
-                //String starts with short arg
-                bool match = true;
-                for (size_t i = 0; i < kv.first.size(); ++i) {
-                    if (kv.first[i] != str[i]) {
-                        match = false;
-                        break;
-                    }
-                }
-
-                bool no_space_between_short_arg_and_value = str.size() > kv.first.size();
-
-                if (match && no_space_between_short_arg_and_value) {
-                    //Only handles cases where there is no space between short arg and value
-                    short_arg_info.is_no_space_short_arg = true;
-                    short_arg_info.arg = kv.second;
-                    short_arg_info.value = std::string(str.begin() + kv.first.size(), str.end());
+    ArgumentParser& ArgumentParser::subparser_for(int index) {
+        Subcommand& subcommand = subcommands_[index];
+        if (!subcommand.parser) {
+            //First use, construct the sub-command's parser
+            subcommand.parser.reset(new ArgumentParser(prog_ + " " + subcommand.name, subcommand.help, os_));
+            subcommand.parser->record_parse_state_ = record_parse_state_;
+            subcommand.factory(*subcommand.parser);
+        }
+        return *subcommand.parser;
+    }
 
-                    return short_arg_info;
-                }
+    std::vector<std::string> ArgumentParser::suggest_options(const std::string& str, const std::map<std::string, ArgumentId>& str_to_option_arg) const {
+        if (option_index_size_ != str_to_option_arg.size() || option_index_.empty()) {
+            //Re-build the index only when the set of options has changed
+            std::vector<std::string> option_strs;
+            option_strs.reserve(str_to_option_arg.size());
+            for (const auto& kv : str_to_option_arg) {
+                option_strs.push_back(kv.first);
             }
+            option_index_ = SuggestionIndex(option_strs);
+            option_index_size_ = str_to_option_arg.size();
         }
-
-        assert(!short_arg_info.is_no_space_short_arg);
-        return short_arg_info;
+        return option_index_.suggest(str);
     }
 
     /*
      * ArgumentGroup
      */
-    ArgumentGroup::ArgumentGroup(std::string name_str)
-        : name_(name_str)
+    ArgumentGroup::ArgumentGroup(std::string name_str, std::shared_ptr<ArgumentTable> argument_table)
+        : argument_table_(argument_table)
+        , name_(&argument_table_->strings().intern(name_str))
         {}
 
     ArgumentGroup& ArgumentGroup::epilog(std::string str) {
         epilog_ = str;
         return *this;
     }
-    std::string ArgumentGroup::name() const { return name_; }
-    std::string ArgumentGroup::epilog() const { return epilog_; }
-    const std::vector<std::shared_ptr<Argument>>& ArgumentGroup::arguments() const { return arguments_; }
 
-    /*
-     * Argument
-     */
-    Argument::Argument(std::string long_opt, std::string short_opt)
-        : long_opt_(long_opt)
-        , short_opt_(short_opt) {
+    ArgumentGroup& ArgumentGroup::epilog(StaticText str) {
+        epilog_ = str;
+        return *this;
+    }
 
-        if (long_opt_.size() < 1) {
-            throw ArgParseError("Argument must be at least one character long");
+    ArgumentGroup& ArgumentGroup::add_arguments(std::vector<ArgumentSpec> specs) {
+        //Check every specification first, so an invalid one leaves the group unchanged
+        for (auto& spec : specs) {
+            Argument::check_spec(spec);
         }
 
-        auto dashes_name = split_leading_dashes(long_opt_);
+        argument_table_->reserve(specs.size());
+        arguments_.reserve(arguments_.size() + specs.size());
 
-        if (dashes_name[0].size() == 1 && !short_opt_.empty()) {
-            throw ArgParseError("Long option must be specified before short option");
-        } else if (dashes_name[0].size() > 2) {
-            throw ArgParseError("More than two dashes in argument name");
+        for (auto& spec : specs) {
+            auto& arg = argument_table_->emplace<Argument>(*argument_table_, spec.dest, spec.ops, std::move(spec.long_opt), std::move(spec.short_opt));
+            arguments_.push_back(&arg);
+            arg.configure(std::move(spec));
+            arg.cold().group_name = name_; //Tag the option with the group (already interned)
+        }
+        return *this;
+    }
+
+    ArgumentGroup& ArgumentGroup::mutually_exclusive() {
+        ArgumentConstraint constraint;
+        constraint.kind = ArgumentConstraint::Kind::MUTUALLY_EXCLUSIVE;
+        constraint.group = name_;
+        argument_table_->add_constraint(constraint);
+        return *this;
+    }
+
+    ArgumentGroup& ArgumentGroup::at_least_one() {
+        ArgumentConstraint constraint;
+        constraint.kind = ArgumentConstraint::Kind::AT_LEAST_ONE;
+        constraint.group = name_;
+        argument_table_->add_constraint(constraint);
+        return *this;
+    }
+    uint64_t ArgumentGroup::config_fingerprint() const {
+        //Summing the (mixed) contributions lets each argument's be updated independently
+        uint64_t hash = 0;
+        for (const Argument* arg : arguments_) {
+            if (arg->in_config_fingerprint()) {
+                hash += arg->value_fingerprint();
+            }
+        }
+        return hash;
+    }
+
+    const std::string& ArgumentGroup::name() const { return *name_; }
+    std::string ArgumentGroup::epilog() const { return epilog_.str(); }
+    const std::vector<Argument*>& ArgumentGroup::arguments() const { return arguments_; }
+
+    /*
+     * Argument
+     */
+    Argument::Argument(ArgumentTable& argument_table, void* dest, const ValueOps* ops, std::string long_opt, std::string short_opt)
+        : argument_table_(&argument_table)
+        , id_(argument_table.add(this))
+        , dest_(dest)
+        , ops_(ops) {
+
+        check_option_names(long_opt, short_opt);
+        auto dashes_name = split_leading_dashes(long_opt);
+
+        StringPool& strings = argument_table.strings();
+        ArgumentCold& arg_cold = cold();
+        arg_cold.long_opt = &strings.intern(long_opt);
+        arg_cold.short_opt = &strings.intern(short_opt);
+        arg_cold.group_name = &empty_string();
+
+        //The descriptive name is fixed, so build it once
+        std::string name_str = long_opt;
+        if (!short_opt.empty()) {
+            name_str += "/" + short_opt;
         }
+        arg_cold.name = &strings.intern(name_str);
 
         //Set defaults
-        metavar_ = toupper(dashes_name[1]);
+        arg_cold.metavar = &strings.intern(toupper(dashes_name[1]));
+
+        //Positional arguments are always required
+        bool is_positional = dashes_name[0].empty();
+        hot().set(ArgumentHot::POSITIONAL, is_positional);
+        hot().set(ArgumentHot::REQUIRED, is_positional);
     }
 
     Argument& Argument::help(std::string help_str) {
-        help_ = help_str;
+        cold().help = help_str;
+        return *this;
+    }
+
+    Argument& Argument::help(StaticText help_str) {
+        cold().help = help_str;
         return *this;
     }
 
     Argument& Argument::nargs(char nargs_type) {
+        check_nargs(action(), nargs_type);
+
+        hot().nargs = nargs_type;
+
+        if (positional()) {
+            //A positional taking zero or more values may be omitted
+            hot().set(ArgumentHot::REQUIRED, nargs_type != '*');
+        }
+
+        valid_action();
+        return *this;
+    }
+
+    void Argument::check_option_names(const std::string& long_opt, const std::string& short_opt) {
+        if (long_opt.size() < 1) {
+            throw ArgParseError("Argument must be at least one character long");
+        }
+
+        auto dashes_name = split_leading_dashes(long_opt);
+
+        if (dashes_name[0].size() == 1 && !short_opt.empty()) {
+            throw ArgParseError("Long option must be specified before short option");
+        } else if (dashes_name[0].size() > 2) {
+            throw ArgParseError("More than two dashes in argument name");
+        }
+    }
+
+    void Argument::check_nargs(Action action_type, char nargs_type) {
         //TODO: nargs > 1 support: '?', '*', '+'
         auto valid_nargs = {'0', '1', '+', '*'};
 
@@ -459,41 +1741,146 @@ namespace argparse {
         }
 
         //Ensure nargs is consistent with the action
-        if (action() == Action::STORE_FALSE && nargs_type != '0') {
+        if (action_type == Action::STORE_FALSE && nargs_type != '0') {
             throw ArgParseError("STORE_FALSE action requires nargs to be '0'");
-        } else if (action() == Action::STORE_TRUE && nargs_type != '0') {
+        } else if (action_type == Action::STORE_TRUE && nargs_type != '0') {
             throw ArgParseError("STORE_TRUE action requires nargs to be '0'");
-        } else if (action() == Action::HELP && nargs_type != '0') {
+        } else if (action_type == Action::HELP && nargs_type != '0') {
             throw ArgParseError("HELP action requires nargs to be '0'");
-        } else if (action() == Action::STORE && (nargs_type != '1' && nargs_type != '+' && nargs_type != '*')) {
+        } else if (action_type == Action::STORE && (nargs_type != '1' && nargs_type != '+' && nargs_type != '*')) {
             throw ArgParseError("STORE action requires nargs to be '1', '+' or '*'");
         }
+    }
+
+    Argument& Argument::metavar(std::string metavar_str) {
+        cold().metavar = &argument_table_->strings().intern(metavar_str);
+        return *this;
+    }
 
-        nargs_ = nargs_type;
+    Argument& Argument::choices(std::vector<std::string> choice_values) {
+        if (delimiter() && !choice_values.empty()) {
+            throw ArgParseError("Delimited argument " + name() + " can not have choices");
+        }
 
-        valid_action();
+        ArgumentCold& arg_cold = cold();
+        arg_cold.choices = choice_values;
+        arg_cold.choice_index = SuggestionIndex(arg_cold.choices);
+        hot().set(ArgumentHot::HAS_CHOICES, !arg_cold.choices.empty());
         return *this;
     }
 
-    Argument& Argument::metavar(std::string metavar_str) {
-        metavar_ = metavar_str;
+    Argument& Argument::delimiter(char delim) {
+        if (ops_->kind != ValueOps::Kind::MULTI) {
+            throw ArgParseError("Only multi value arguments can have a delimiter (" + name() + ")");
+        } else if (!choices().empty()) {
+            throw ArgParseError("Argument " + name() + " with choices can not have a delimiter");
+        }
+
+        hot().delimiter = delim;
         return *this;
     }
 
-    Argument& Argument::choices(std::vector<std::string> choice_values) {
-        choices_ = choice_values;
+    Argument& Argument::in_config_fingerprint(bool included) {
+        cold().in_config_fingerprint = included;
+        return *this;
+    }
+
+    Argument& Argument::memoize(size_t max_entries) {
+        argument_table_->check_not_frozen();
+        if (max_entries == 0) {
+            cold().memo.reset();
+        } else {
+            cold().memo = ops_->make_memo(max_entries);
+        }
+        hot().set(ArgumentHot::MEMOIZED, max_entries != 0);
         return *this;
     }
 
+    void Argument::check_spec(ArgumentSpec& spec) {
+        if (!spec.dest || !spec.ops) {
+            throw ArgParseError("Argument specification has no destination (see argument_spec())");
+        }
+        check_option_names(spec.long_opt, spec.short_opt);
+
+        if (   spec.action_type != Action::STORE
+            && spec.action_type != Action::STORE_TRUE
+            && spec.action_type != Action::STORE_FALSE
+            && spec.action_type != Action::HELP
+            && spec.action_type != Action::VERSION) {
+            throw ArgParseError("Unrecognized argparse action");
+        }
+
+        if (spec.nargs_type == '\0') {
+            spec.nargs_type = (spec.action_type == Action::STORE) ? '1' : '0';
+        }
+        check_nargs(spec.action_type, spec.nargs_type);
+        check_action(spec.ops->kind, spec.action_type, spec.long_opt);
+
+        if (spec.has_default && spec.nargs_type != '+' && spec.nargs_type != '*' && spec.default_values.size() != 1) {
+            std::stringstream msg;
+            msg << "Multiple default value not allowed for nargs='" << spec.nargs_type << "'";
+            throw ArgParseError(msg.str());
+        }
+
+        if (spec.choice_values.empty() && spec.default_choices) {
+            spec.choice_values = spec.default_choices();
+        }
+        if (spec.delim) {
+            std::string name_str = spec.long_opt;
+            if (!spec.short_opt.empty()) {
+                name_str += "/" + spec.short_opt;
+            }
+
+            if (spec.ops->kind != ValueOps::Kind::MULTI) {
+                throw ArgParseError("Only multi value arguments can have a delimiter (" + name_str + ")");
+            } else if (!spec.choice_values.empty()) {
+                throw ArgParseError("Argument " + name_str + " with choices can not have a delimiter");
+            }
+        }
+    }
+
+    void Argument::configure(ArgumentSpec&& spec) {
+        ArgumentHot& arg_hot = hot();
+        ArgumentCold& arg_cold = cold();
+
+        arg_hot.action = spec.action_type;
+        arg_hot.nargs = spec.nargs_type;
+
+        if (positional()) {
+            //A positional taking zero or more values may be omitted
+            arg_hot.set(ArgumentHot::REQUIRED, spec.nargs_type != '*');
+        } else {
+            arg_hot.set(ArgumentHot::REQUIRED, spec.is_required);
+        }
+
+        if (spec.has_default) {
+            arg_cold.default_value = std::move(spec.default_values);
+            arg_hot.set(ArgumentHot::DEFAULT_SET, true);
+        }
+
+        arg_hot.delimiter = spec.delim;
+        if (!spec.choice_values.empty()) {
+            arg_cold.choices = std::move(spec.choice_values);
+            arg_cold.choice_index = SuggestionIndex(arg_cold.choices);
+            arg_hot.set(ArgumentHot::HAS_CHOICES, true);
+        }
+
+        arg_cold.help = std::move(spec.help_text);
+        if (!spec.metavar_str.empty()) {
+            arg_cold.metavar = &argument_table_->strings().intern(spec.metavar_str);
+        }
+        arg_cold.show_in = spec.show;
+    }
+
     Argument& Argument::action(Action action_type) {
-        action_ = action_type;
+        hot().action = action_type;
 
-        if (   action_ == Action::STORE_FALSE 
-            || action_ == Action::STORE_TRUE 
-            || action_ == Action::HELP 
-            || action_ == Action::VERSION) {
+        if (   action_type == Action::STORE_FALSE 
+            || action_type == Action::STORE_TRUE 
+            || action_type == Action::HELP 
+            || action_type == Action::VERSION) {
             this->nargs('0');
-        } else if (action_ == Action::STORE) {
+        } else if (action_type == Action::STORE) {
             this->nargs('1');
         } else {
             throw ArgParseError("Unrecognized argparse action");
@@ -503,7 +1890,7 @@ namespace argparse {
     }
 
     Argument& Argument::required(bool is_required) {
-        required_ = is_required;
+        hot().set(ArgumentHot::REQUIRED, is_required || positional());
         return *this;
     }
 
@@ -513,9 +1900,10 @@ namespace argparse {
             msg << "Scalar default value not allowed for nargs='" << nargs() << "'";
             throw ArgParseError(msg.str());
         }
-        default_value_.clear();
-        default_value_.push_back(value);
-        default_set_ = true;
+        auto& default_vals = cold().default_value;
+        default_vals.clear();
+        default_vals.push_back(value);
+        hot().set(ArgumentHot::DEFAULT_SET, true);
         return *this;
     }
 
@@ -525,8 +1913,8 @@ namespace argparse {
             msg << "Multiple default value not allowed for nargs='" << nargs() << "'";
             throw ArgParseError(msg.str());
         }
-        default_value_ = values;
-        default_set_ = true;
+        cold().default_value = values;
+        hot().set(ArgumentHot::DEFAULT_SET, true);
         return *this;
     }
 
@@ -536,54 +1924,345 @@ namespace argparse {
     }
 
     Argument& Argument::group_name(std::string grp) {
-        group_name_ = grp;
+        cold().group_name = &argument_table_->strings().intern(grp);
         return *this;
     }
 
     Argument& Argument::show_in(ShowIn show) {
-        show_in_ = show;
+        cold().show_in = show;
         return *this;
     }
 
-    std::string Argument::name() const { 
-        std::string name_str = long_option();
-        if (!short_option().empty()) {
-            name_str += "/" + short_option();
-        }
-        return name_str;
-    }
-
-    std::string Argument::long_option() const { return long_opt_; }
-    std::string Argument::short_option() const { return short_opt_; }
-    std::string Argument::help() const { return help_; }
-    char Argument::nargs() const { return nargs_; }
-    std::string Argument::metavar() const { return metavar_; }
-    std::vector<std::string> Argument::choices() const { return choices_; }
-    Action Argument::action() const { return action_; }
+    ArgumentId Argument::id() const { return id_; }
+    const std::string& Argument::name() const { return *cold().name; }
+    const std::string& Argument::long_option() const { return *cold().long_opt; }
+    const std::string& Argument::short_option() const { return *cold().short_opt; }
+    std::string Argument::help() const { return cold().help.str(); }
+    char Argument::nargs() const { return hot().nargs; }
+    const std::string& Argument::metavar() const { return *cold().metavar; }
+    const std::vector<std::string>& Argument::choices() const { return cold().choices; }
+    char Argument::delimiter() const { return hot().delimiter; }
+    Action Argument::action() const { return hot().action; }
     std::string Argument::default_value() const { 
-        if (default_value_.size() > 1) {
+        const auto& default_vals = cold().default_value;
+        if (default_vals.size() > 1) {
             std::stringstream msg;
-            msg << "{" << join(default_value_, ", ") << "}";
+            msg << "{" << join(default_vals, ", ") << "}";
             return msg.str();
-        } else if (default_value_.size() == 1) {
-            return default_value_[0]; 
+        } else if (default_vals.size() == 1) {
+            return default_vals[0]; 
         } else {
             return "";
         }
     }
-    std::string Argument::group_name() const { return group_name_; }
-    ShowIn Argument::show_in() const { return show_in_; }
-    bool Argument::default_set() const { return default_set_; }
+    const std::string& Argument::group_name() const { return *cold().group_name; }
+    ShowIn Argument::show_in() const { return cold().show_in; }
+    bool Argument::default_set() const { return hot().has(ArgumentHot::DEFAULT_SET); }
+    bool Argument::required() const { return hot().has(ArgumentHot::REQUIRED); }
+    bool Argument::positional() const { return hot().has(ArgumentHot::POSITIONAL); }
+    bool Argument::is_chunked() const { return hot().has(ArgumentHot::CHUNKED); }
+
+    MemoStats Argument::memo_stats() const {
+        if (!conversion_memo()) {
+            return MemoStats();
+        }
+        return conversion_memo()->stats();
+    }
+
+    const std::vector<std::string>& Argument::default_values() const { return cold().default_value; }
+    bool Argument::in_config_fingerprint() const { return cold().in_config_fingerprint; }
+
+    ArgumentHot& Argument::hot() { return argument_table_->hot(id_); }
+    const ArgumentHot& Argument::hot() const { return argument_table_->hot(id_); }
+    ArgumentCold& Argument::cold() { return argument_table_->cold(id_); }
+    const ArgumentCold& Argument::cold() const { return argument_table_->cold(id_); }
+
+    void Argument::set_dest_to_default() {
+        value_changed();
+        ops_->set_to_default(*this, dest_);
+    }
+
+    void Argument::set_dest_to_value(const std::string& value) {
+        if (ops_->kind == ValueOps::Kind::MULTI) {
+            throw ArgParseError("Multi-value option can not be set to a single value");
+        }
+        value_changed();
+        ops_->store_value(*this, dest_, value);
+    }
+
+    void Argument::add_value_to_dest(const std::string& value) {
+        if (ops_->kind != ValueOps::Kind::MULTI) {
+            throw ArgParseError("Single value option can not have multiple values set");
+        }
+        value_changed();
+        ops_->store_value(*this, dest_, value);
+    }
+
+    void Argument::set_dest_to_true() {
+        if (ops_->kind != ValueOps::Kind::BOOL) {
+            throw ArgParseError("Non-boolean destination can not be set true");
+        }
+        value_changed();
+        auto& target = *static_cast<ArgValue<bool>*>(dest_);
+        target.set(true, Provenance::SPECIFIED);
+        target.set_argument_id(id_);
+    }
+
+    void Argument::set_dest_to_false() {
+        if (ops_->kind != ValueOps::Kind::BOOL) {
+            throw ArgParseError("Non-boolean destination can not be set false");
+        }
+        value_changed();
+        auto& target = *static_cast<ArgValue<bool>*>(dest_);
+        target.set(false, Provenance::SPECIFIED);
+        target.set_argument_id(id_);
+    }
+
+    const void* Argument::destination() const { return dest_; }
+    void* Argument::destination() { return dest_; }
+
+    const ValueOps& Argument::value_ops() const { return *ops_; }
+
+    ConversionMemoBase* Argument::conversion_memo() const {
+        if (!hot().has(ArgumentHot::MEMOIZED)) {
+            return nullptr;
+        }
+        return cold().memo.get();
+    }
+
+    void Argument::reset_dest() {
+        value_changed();
+        ops_->reset(dest_);
+    }
+
+    void Argument::flush_dest_chunk(bool final) {
+        if (cold().flush_chunk) {
+            value_changed();
+            cold().flush_chunk(dest_, final);
+        }
+    }
+
+    void Argument::value_changed() {
+        //Every argument bound to the destination observes the new value
+        argument_table_->link_destinations_if_needed();
+        ArgumentId id = id_;
+        do {
+            ArgumentCold& arg_cold = argument_table_->cold(id);
+            arg_cold.value_hash_valid = false;
+            id = arg_cold.next_same_dest;
+        } while (id != id_);
+    }
+
+    uint64_t Argument::value_fingerprint() const {
+        ArgumentCold& arg_cold = argument_table_->cold(id_);
+        if (arg_cold.value_hash_valid) {
+            return arg_cold.value_hash;
+        }
+
+        if (!ops_->append_strs) {
+            throw ArgParseError("Converter for " + name() + " has no to_str() to fingerprint its value");
+        }
+        CommandLine value_strs;
+        try {
+            ops_->append_strs(dest_, value_strs);
+        } catch (const ArgParseConversionError& e) {
+            throw ArgParseConversionError(std::string(e.what()) + " for " + name());
+        }
+
+        Fnv1aHash hash;
+        hash.add(long_option());
+        hash.add_value<uint64_t>(value_strs.size());
+        for (size_t i = 0; i < value_strs.size(); ++i) {
+            hash.add(std::string(value_strs[i]));
+        }
+
+        arg_cold.value_hash = mix_hash(hash.value());
+        arg_cold.value_hash_valid = true;
+        return arg_cold.value_hash;
+    }
+
+    bool Argument::is_valid_value(const std::string& value) const {
+        if (hot().delimiter) {
+            return ops_->is_convertible_fields(value, hot().delimiter, nullptr); //No choices
+        }
+        if (!ops_->is_convertible(*this, value)) {
+            return false;
+        }
+        return is_valid_choice(value, choices());
+    }
+
+    void Argument::valid_action() const {
+        check_action(ops_->kind, action(), long_option());
+    }
+
+    void Argument::check_action(ValueOps::Kind kind, Action action_type, const std::string& long_opt) {
+        if (kind == ValueOps::Kind::BOOL) {
+            //Any supported action is valid on a boolean destination
+            return;
+        }
+
+        //Sanity check that we aren't processing a boolean action with a non-boolean destination
+        if (kind == ValueOps::Kind::SINGLE && action_type == Action::STORE_TRUE) {
+            std::stringstream msg;
+            msg << "Non-boolean destination can not have STORE_TRUE action (" << long_opt << ")";
+            throw ArgParseError(msg.str());
+        } else if (kind == ValueOps::Kind::SINGLE && action_type == Action::STORE_FALSE) {
+            std::stringstream msg;
+            msg << "Non-boolean destination can not have STORE_FALSE action (" << long_opt << ")";
+            throw ArgParseError(msg.str());
+        } else if (action_type != Action::STORE) {
+            throw ArgParseError("Unexpected action (expected STORE)");
+        }
+    }
+
+    const std::string& Argument::argument_name(ArgumentId id) const {
+        return argument_table_->argument(id).name();
+    }
+
+    std::vector<std::string> Argument::suggest_choices(const std::string& value, size_t max_results) const {
+        return cold().choice_index.suggest(value, max_results);
+    }
+
+    /*
+     * ParseHandler
+     */
+    void ParseHandler::on_option(const Argument& /*arg*/, const std::string& /*option_str*/) {}
+    void ParseHandler::on_value(const Argument& /*arg*/, const std::string& /*value*/) {}
+    void ParseHandler::on_positional(const Argument& /*arg*/, const std::string& /*value*/) {}
+    void ParseHandler::on_subcommand(const ArgumentParser& /*subparser*/, const std::string& /*name*/) {}
+    void ParseHandler::on_error(const ArgParseError& /*error*/) {}
+    void ParseHandler::on_end() {}
+
+    /*
+     * ParseState
+     */
+    const std::vector<std::string>& ParseState::args() const { return args_; }
+
+    std::vector<std::vector<size_t>> ParseState::occurrences_by_argument() const {
+        std::vector<std::vector<size_t>> by_arg(num_arguments_);
+        for (size_t i = 0; i < occurrences_.size(); ++i) {
+            by_arg[occurrences_[i].arg].push_back(i);
+        }
+        return by_arg;
+    }
+
+    bool ParseState::same_occurrences(const std::vector<size_t>& occurrences, const ParseState& other, const std::vector<size_t>& other_occurrences) const {
+        if (occurrences.size() != other_occurrences.size()) return false;
+
+        for (size_t i = 0; i < occurrences.size(); ++i) {
+            const Occurrence& occurrence = occurrences_[occurrences[i]];
+            const Occurrence& other_occurrence = other.occurrences_[other_occurrences[i]];
+            if (occurrence.num_values() != other_occurrence.num_values()) return false;
+
+            for (size_t j = 0; j < occurrence.num_values(); ++j) {
+                size_t offset = (j == 0 ? occurrence.offset : 0);
+                size_t other_offset = (j == 0 ? other_occurrence.offset : 0);
+                if (args_[occurrence.first + j].compare(offset, std::string::npos,
+                                                        other.args_[other_occurrence.first + j], other_offset, std::string::npos) != 0) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void ParseState::add_value(const std::string& value) {
+        //Values are reported as their tokens are read, so value is from the last token
+        assert(!args_.empty() && !occurrences_.empty());
+        const std::string& token = args_.back();
+        assert(token.size() >= value.size() && token.compare(token.size() - value.size(), value.size(), value) == 0);
+
+        Occurrence& occurrence = occurrences_.back();
+        size_t index = args_.size() - 1;
+        if (occurrence.num_values() == 0) {
+            occurrence.first = index;
+            occurrence.last = index;
+            occurrence.offset = token.size() - value.size();
+        }
+        assert(index == occurrence.first + occurrence.num_values());
+        occurrence.last = index + 1;
+    }
+
+    /*
+     * CommandLine
+     */
+    void CommandLine::push_back(const std::string& arg) {
+        offsets_.push_back(buffer_.size());
+        buffer_.insert(buffer_.end(), arg.begin(), arg.end());
+        buffer_.push_back('\0');
+    }
+
+    void CommandLine::reserve(size_t num_args, size_t num_chars) {
+        offsets_.reserve(num_args);
+        buffer_.reserve(num_chars + num_args);
+    }
+
+    size_t CommandLine::size() const { return offsets_.size(); }
+    const char* CommandLine::operator[](size_t i) const { return buffer_.data() + offsets_[i]; }
+    const std::vector<char>& CommandLine::buffer() const { return buffer_; }
+    const std::vector<size_t>& CommandLine::offsets() const { return offsets_; }
+
+    char* const* CommandLine::argv() {
+        argv_.clear();
+        argv_.reserve(offsets_.size() + 1);
+        for (size_t offset : offsets_) {
+            argv_.push_back(buffer_.data() + offset);
+        }
+        argv_.push_back(nullptr);
+        return argv_.data();
+    }
 
-    bool Argument::required() const {
-        if(positional()) {
-            //Positional arguments are always required
-            return true;
+    std::vector<std::string> CommandLine::args() const {
+        std::vector<std::string> arg_strs;
+        for (size_t i = 0; i < size(); ++i) {
+            arg_strs.push_back((*this)[i]);
+        }
+        return arg_strs;
+    }
+
+    /*
+     * Snapshot
+     */
+    Snapshot::Snapshot(Snapshot&& other) noexcept {
+        swap(other);
+    }
+
+    Snapshot& Snapshot::operator=(Snapshot&& other) noexcept {
+        Snapshot tmp(std::move(other));
+        swap(tmp);
+        return *this;
+    }
+
+    Snapshot::~Snapshot() {
+        for (const auto& object : objects_) {
+            object.ops->destroy(buffer_.get() + object.offset);
         }
-        return required_;
     }
-    bool Argument::positional() const {
-        assert(long_option().size() > 1);
-        return long_option()[0] != '-';
+
+    size_t Snapshot::size() const { return size_; }
+
+    void Snapshot::swap(Snapshot& other) noexcept {
+        using std::swap;
+        swap(buffer_, other.buffer_);
+        swap(size_, other.size_);
+        swap(runs_, other.runs_);
+        swap(objects_, other.objects_);
+        swap(parser_, other.parser_);
+        swap(num_arguments_, other.num_arguments_);
+        swap(parse_state_, other.parse_state_);
+        swap(parse_state_current_, other.parse_state_current_);
+        swap(selected_subcommand_, other.selected_subcommand_);
+        swap(subcommands_, other.subcommands_);
+        swap(subcommand_snapshots_, other.subcommand_snapshots_);
+    }
+
+    /*
+     * Utilities
+     */
+    //Finalizes a hash (splitmix64), so that sums of hashes remain well distributed
+    static uint64_t mix_hash(uint64_t hash) {
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+        return hash ^ (hash >> 31);
     }
 } //namespace
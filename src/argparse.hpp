@@ -1,34 +1,336 @@
 #ifndef ARGPARSE_H
 #define ARGPARSE_H
 #include <iosfwd>
+#include <limits>
 #include <string>
 #include <vector>
 #include <iostream>
 #include <sstream>
 #include <memory>
 #include <map>
+#include <functional>
+#include <typeinfo>
 
 #include "argparse_formatter.hpp"
 #include "argparse_default_converter.hpp"
 #include "argparse_error.hpp"
 #include "argparse_value.hpp"
+#include "argparse_suggestion.hpp"
+#include "argparse_argument_table.hpp"
+#include "argparse_stats.hpp"
+#include "argparse_token_source.hpp"
+#include "argparse_thread_pool.hpp"
+#include "argparse_schema.hpp"
 
 namespace argparse {
 
     class Argument;
     class ArgumentGroup;
+    class ArgumentParser;
+    class ParseState;
+    class ParseHandler;
+    class CommandLine;
+    struct OptionTable;
+
+    //Function which adds a sub-command's arguments to its (newly constructed) parser
+    typedef std::function<void(ArgumentParser&)> SubparserFactory;
+
+    /*
+     * Type-specific operations on an argument's destination
+     *
+     * The operations are bound (see make_value_ops()) when the argument is added. There is
+     * one static table per destination type and converter, referenced by each Argument, so
+     * setting a value is a direct call through the table rather than a virtual call into a
+     * per-type subclass.
+     */
+    struct ValueOps {
+        enum class Kind : uint8_t {
+            SINGLE, //ArgValue<T>
+            BOOL,   //ArgValue<bool>, which also supports STORE_TRUE/STORE_FALSE
+            MULTI   //ArgValue<std::vector<T>>
+        };
+        Kind kind;
+
+        //Returns true if value converts to the destination type (for arg)
+        bool (*is_convertible)(const Argument& arg, const std::string& value);
+
+        //Returns true if each field of value (separated by delimiter) converts to the destination's
+        //element type, otherwise setting error (if non-null) to describe the first invalid field.
+        //(MULTI only, null otherwise)
+        bool (*is_convertible_fields)(const std::string& value, char delimiter, std::string* error);
+
+        //Sets dest to the argument's default value(s)
+        void (*set_to_default)(const Argument& arg, void* dest);
+
+        //Sets (SINGLE/BOOL) or appends to (MULTI) dest from value (or each of its fields, if the argument has a delimiter)
+        void (*store_value)(const Argument& arg, void* dest, const std::string& value);
+
+        //For converters whose from_str() returns a std::future: starts converting value (running a deferred
+        //conversion on pool) and returns a function which waits for the result, then sets (SINGLE/BOOL) or
+        //appends to (MULTI) dest as store_value() would. Null for converters which convert immediately
+        std::function<void()> (*start_store_value)(const Argument& arg, void* dest, const std::string& value, ThreadPool& pool);
+
+        //Resets dest to its initial state
+        void (*reset)(void* dest);
+
+        //Size and alignment of dest
+        size_t size;
+        size_t alignment;
+
+        //Whether dest can be saved and restored by copying its bytes
+        bool trivially_copyable;
+
+        //Copy constructs a saved copy of dest at storage
+        void (*save)(void* storage, const void* dest);
+
+        //Assigns dest from the saved copy at storage
+        void (*load)(void* dest, const void* storage);
+
+        //Destroys the saved copy at storage
+        void (*destroy)(void* storage);
+
+        //Appends dest's value and provenance to out (null if the type can not be serialized)
+        void (*serialize)(const void* dest, std::string& out);
+
+        //Reads a value serialized by serialize() from data, advancing it, and sets dest
+        //(if dest is null the value is only checked). Returns false if the data is malformed
+        bool (*deserialize)(void* dest, const char*& data, const char* end);
+
+        //The destination's value type and converter
+        const std::type_info* value_type;
+        const std::type_info* converter_type;
+
+        //Returns the ID of the argument which specified dest (or NO_ARGUMENT_ID if it was not SPECIFIED)
+        ArgumentId (*specified_by)(const void* dest);
+
+        //Appends dest's value(s) converted to strings (null if the converter has no to_str())
+        void (*append_strs)(const void* dest, CommandLine& out);
+
+        //Returns the value type recorded in a ParserSchema (see arg_type()), or an empty string if only
+        //the converter can check values
+        std::string (*schema_type)();
+
+        //Returns an empty memo of conversions to the destination's (element) type (see Argument::memoize())
+        std::unique_ptr<ConversionMemoBase> (*make_memo)(size_t max_entries);
+    };
+
+    /*
+     * The complete definition of an argument, for registering many arguments at once
+     * (see ArgumentGroup::add_arguments())
+     *
+     * The setters only record their values, which are validated together when the
+     * argument is added, rather than re-validating the argument as each is applied.
+     */
+    struct ArgumentSpec {
+        void* dest = nullptr;
+        const ValueOps* ops = nullptr;
+        std::vector<std::string> (*default_choices)() = nullptr; //The converter's default choices
+        std::string long_opt;
+        std::string short_opt;
+
+        HelpText help_text;
+        std::string metavar_str; //Inferred from the option name if empty
+        Action action_type = Action::STORE;
+        char nargs_type = '\0'; //Inferred from the action if '\0'
+        bool is_required = false;
+        bool has_default = false;
+        std::vector<std::string> default_values;
+        std::vector<std::string> choice_values; //The converter's default choices if empty
+        char delim = '\0';
+        ShowIn show = ShowIn::USAGE_AND_HELP;
+
+        ArgumentSpec& help(std::string str) { help_text = std::move(str); return *this; }
+        ArgumentSpec& help(StaticText str) { help_text = str; return *this; }
+        ArgumentSpec& metavar(std::string str) { metavar_str = std::move(str); return *this; }
+        ArgumentSpec& action(Action type) { action_type = type; return *this; }
+        ArgumentSpec& nargs(char type) { nargs_type = type; return *this; }
+        ArgumentSpec& required(bool value) { is_required = value; return *this; }
+        ArgumentSpec& default_value(std::string value) { return default_value(std::vector<std::string>{std::move(value)}); }
+        ArgumentSpec& default_value(std::vector<std::string> values) { default_values = std::move(values); has_default = true; return *this; }
+        ArgumentSpec& choices(std::vector<std::string> values) { choice_values = std::move(values); return *this; }
+        ArgumentSpec& delimiter(char value) { delim = value; return *this; }
+        ArgumentSpec& show_in(ShowIn value) { show = value; return *this; }
+    };
+
+    //Returns the specification of an argument or option (single value)
+    template<typename T, typename Converter=DefaultConverter<T>>
+    ArgumentSpec argument_spec(ArgValue<T>& dest, std::string long_opt, std::string short_opt=std::string());
+
+    //Returns the specification of an argument or option (multi value)
+    template<typename T, typename Converter=DefaultConverter<T>>
+    ArgumentSpec argument_spec(ArgValue<std::vector<T>>& dest, std::string long_opt, std::string short_opt=std::string());
+
+    /*
+     * Receives the arguments of a command-line as they are resolved (see ArgumentParser::parse_events())
+     *
+     * No destinations are set and no values are collected, so memory use does not grow
+     * with the length of the command-line, and values can be processed (e.g. forwarded)
+     * while parsing continues. The default implementations ignore the event.
+     */
+    class ParseHandler {
+        public:
+            virtual ~ParseHandler() = default;
+
+            //An option (e.g. '--foo', or the '-f' of '-f3') which specifies arg.
+            //Help and version options are reported like any other, and are not acted on
+            virtual void on_option(const Argument& arg, const std::string& option_str);
+
+            //A value of the preceding option (which has been checked against the valid choices)
+            virtual void on_value(const Argument& arg, const std::string& value);
+
+            //A positional argument
+            virtual void on_positional(const Argument& arg, const std::string& value);
+
+            //A sub-command, whose arguments (the rest of the command-line) are reported next
+            virtual void on_subcommand(const ArgumentParser& subparser, const std::string& name);
+
+            //An error, which ends the parse
+            virtual void on_error(const ArgParseError& error);
+
+            //The end of a successful parse
+            virtual void on_end();
+    };
+
+    /*
+     * The arguments resolved by a successful parse (see ArgumentParser::parse_state())
+     *
+     * Records the values specified for each argument, so a later parse of an edited
+     * command-line can re-set only the arguments which changed (see ArgumentParser::reparse_args_throw()).
+     */
+    class ParseState {
+        public:
+            //Returns the command-line arguments which were parsed
+            const std::vector<std::string>& args() const;
+        private:
+            friend class ArgumentParser;
+
+            //Returns the indices of each argument's occurrences (indexed by ArgumentId)
+            std::vector<std::vector<size_t>> occurrences_by_argument() const;
+
+            //Returns true if the specified occurrences of this and other have the same values
+            bool same_occurrences(const std::vector<size_t>& occurrences, const ParseState& other, const std::vector<size_t>& other_occurrences) const;
+        private:
+            //A single use of an argument on the command-line, whose values are the
+            //args_ in [first, last). The first value starts offset characters into its
+            //token (non-zero for a value attached to a short option, e.g. the '3' of '-j3')
+            struct Occurrence {
+                ArgumentId arg = NO_ARGUMENT_ID;
+                size_t first = 0;
+                size_t last = 0;
+                size_t offset = 0;
+
+                size_t num_values() const { return last - first; }
+            };
+
+            //Records value (the last of args_, or a suffix of it) as the next value of the last occurrence
+            void add_value(const std::string& value);
+
+            std::vector<std::string> args_;
+            std::vector<Occurrence> occurrences_; //In command-line order
+            size_t num_arguments_ = 0; //Number of arguments in the parser
+            int subcommand_ = -1; //Index of the selected sub-command
+            size_t subcommand_args_ = 0; //Index into args_ of the sub-command's first argument
+
+            const ArgumentParser* parser_ = nullptr; //The parser which produced this state
+            size_t generation_ = 0; //The parser's parse generation when this state was produced
+    };
+
+    /*
+     * A copy of the values of all of a parser's destinations (see ArgumentParser::snapshot())
+     *
+     * Destinations which are trivially copyable are stored as raw bytes, and those
+     * adjacent in memory are grouped so they are restored with a single copy.
+     * Other destinations are stored as copy-constructed objects.
+     */
+    class Snapshot {
+        public:
+            Snapshot() = default;
+            Snapshot(const Snapshot&) = delete;
+            Snapshot& operator=(const Snapshot&) = delete;
+            Snapshot(Snapshot&& other) noexcept;
+            Snapshot& operator=(Snapshot&& other) noexcept;
+            ~Snapshot();
+
+            //Returns the number of bytes used to store the destination values
+            size_t size() const;
+        private:
+            friend class ArgumentParser;
+
+            void swap(Snapshot& other) noexcept;
+        private:
+            //Adjacent trivially copyable destinations
+            struct Run {
+                void* dest;
+                size_t offset; //Into buffer_
+                size_t size;
+            };
+
+            //A destination which must be copy constructed
+            struct Object {
+                void* dest;
+                size_t offset; //Into buffer_
+                const ValueOps* ops;
+            };
 
-    enum class Action {
-        STORE,
-        STORE_TRUE,
-        STORE_FALSE,
-        HELP,
-        VERSION
+            std::unique_ptr<char[]> buffer_;
+            size_t size_ = 0;
+            std::vector<Run> runs_;
+            std::vector<Object> objects_;
+
+            const ArgumentParser* parser_ = nullptr; //The parser which produced this snapshot
+            size_t num_arguments_ = 0; //Number of arguments in the parser
+
+            ParseState parse_state_; //The parser's last parse
+            bool parse_state_current_ = false; //Whether parse_state_ described the destinations
+            int selected_subcommand_ = -1;
+
+            std::vector<int> subcommands_; //Indices of the sub-commands with parsers
+            std::vector<std::unique_ptr<Snapshot>> subcommand_snapshots_;
     };
 
-    enum class ShowIn {
-        USAGE_AND_HELP,
-        HELP_ONLY
+    /*
+     * A command-line stored in a single buffer (see ArgumentParser::serialize_args())
+     *
+     * The arguments are stored NUL terminated and back-to-back in one buffer, with
+     * their offsets, so a command-line can be built once and handed to many workers
+     * (e.g. with execv(cmd.argv()[0], cmd.argv())) without copying each argument.
+     */
+    class CommandLine {
+        public:
+            CommandLine() = default;
+            CommandLine(const CommandLine&) = delete;
+            CommandLine& operator=(const CommandLine&) = delete;
+            CommandLine(CommandLine&&) = default;
+            CommandLine& operator=(CommandLine&&) = default;
+
+            //Appends an argument
+            void push_back(const std::string& arg);
+
+            //Reserves space for num_args arguments of num_chars characters (in total)
+            void reserve(size_t num_args, size_t num_chars);
+
+            //Returns the number of arguments
+            size_t size() const;
+
+            //Returns the i'th argument
+            const char* operator[](size_t i) const;
+
+            //Returns the buffer holding the (NUL terminated) arguments
+            const std::vector<char>& buffer() const;
+
+            //Returns the offset of each argument in buffer()
+            const std::vector<size_t>& offsets() const;
+
+            //Returns the arguments as a null terminated array (as expected by execv()).
+            //The pointers are invalidated by push_back()
+            char* const* argv();
+
+            //Returns a copy of the arguments
+            std::vector<std::string> args() const;
+        private:
+            std::vector<char> buffer_;
+            std::vector<size_t> offsets_;
+            std::vector<char*> argv_;
     };
 
     class ArgumentParser {
@@ -36,6 +338,9 @@ namespace argparse {
             //Initializes an argument parser
             ArgumentParser(std::string prog_name, std::string description_str=std::string(), std::ostream& os=std::cout);
 
+            //Initializes an argument parser, with a description which is referenced rather than copied
+            ArgumentParser(std::string prog_name, StaticText description_str, std::ostream& os=std::cout);
+
             //Overrides the program name
             ArgumentParser& prog(std::string prog, bool basename_only=true);
 
@@ -44,6 +349,7 @@ namespace argparse {
 
             //Specifies the epilog text at the bottom of the help description
             ArgumentParser& epilog(std::string prog);
+            ArgumentParser& epilog(StaticText epilog_str);
 
             //Adds an argument or option with a single name (single value)
             template<typename T, typename Converter=DefaultConverter<T>>
@@ -61,9 +367,26 @@ namespace argparse {
             template<typename T, typename Converter=DefaultConverter<T>>
             Argument& add_argument(ArgValue<std::vector<T>>& dest, std::string long_opt, std::string short_opt);
 
+            //Adds the arguments and options in specs (see ArgumentGroup::add_arguments())
+            ArgumentParser& add_arguments(std::vector<ArgumentSpec> specs);
+
             //Adds a group to collect related arguments
             ArgumentGroup& add_argument_group(std::string description_str);
 
+            //Adds a sub-command (e.g. 'prog pack ...').
+            //The sub-command's parser is only constructed (by calling factory) once
+            //name is found on the command-line, and parses all the remaining arguments
+            ArgumentParser& add_subcommand(std::string name, SubparserFactory factory, std::string help_str=std::string());
+
+            //Sets whether a sub-command must be specified (if any are registered)
+            ArgumentParser& subcommand_required(bool is_required);
+
+            //Enables caching of parse results in dir (disabled if empty).
+            //A repeated command-line then restores the destinations from the cache instead of
+            //converting the values again. Cached results are only used if the parser's definition
+            //(see fingerprint()) is unchanged, so converters must depend only on their input
+            ArgumentParser& parse_cache_dir(std::string dir);
+
             //Like parse_arg_throw(), but catches exceptions and exits the program
             void parse_args(int argc, const char* const* argv, int error_exit_code=1, int help_exit_code=0, int version_exit_code=0);
 
@@ -74,9 +397,80 @@ namespace argparse {
             void parse_args_throw(int argc, const char* const* argv);
             void parse_args_throw(std::vector<std::string> args);
 
+            //Parses the command-line arguments read from tokens (e.g. a FdTokenSource reading
+            //NUL separated arguments from stdin), without first collecting them.
+            //If the parse cache is enabled all the arguments are read before parsing
+            void parse_args_throw(TokenSource& tokens);
+
+            //Parses args, which are an edit of previous.args() (e.g. from parse_state()).
+            //Only the arguments whose values changed are re-set (and those removed restored to
+            //their defaults), with the same result as reset_destinations() and parse_args_throw(args).
+            //Falls back to a full re-parse if the destinations may have been modified since previous
+            void reparse_args_throw(const ParseState& previous, std::vector<std::string> args);
+
+            //Returns the state of the last successful parse (which is empty unless the
+            //parse was recorded, see record_parse_state())
+            const ParseState& parse_state() const;
+
+            //Sets whether parses are recorded (see parse_state()), so they can be incrementally
+            //re-parsed with reparse_args_throw(). Off by default, in which case each value is set as it
+            //is read and the command-line (e.g. a streamed TokenSource) is never held in memory.
+            //Parses are also recorded while the parse cache is enabled (see parse_cache_dir())
+            ArgumentParser& record_parse_state(bool enable);
+
+            //Resolves the command-line arguments, reporting each to handler as it is resolved
+            //(see ParseHandler) instead of setting the destinations.
+            //Returns false if an error was reported (which ends the parse)
+            bool parse_events(int argc, const char* const* argv, ParseHandler& handler);
+            bool parse_events(std::vector<std::string> args, ParseHandler& handler);
+            bool parse_events(TokenSource& tokens, ParseHandler& handler);
+
+            //Completes the parser's definition: adds the help option, compiles the constraints and
+            //constructs (and freezes) all sub-command parsers. A frozen parser may then be shared by
+            //threads calling parse_events() concurrently (other parses set the destinations, so must not).
+            //Adding arguments, sub-commands, constraints or memos to a frozen parser throws ArgParseError
+            ArgumentParser& freeze();
+
+            //Returns true if the parser has been frozen (see freeze())
+            bool frozen() const;
+
+            //Enables (or disables) collection of statistics for each parse (see parse_stats()).
+            //If allocation_counter is provided the number of allocations during the parse is also recorded
+            ArgumentParser& collect_parse_stats(bool enable, AllocationCounter allocation_counter=AllocationCounter());
+
+            //Sets a hidden option (not shown in the help, e.g. "--dump-parse-stats") which
+            //collects and prints the statistics of the parse it is specified on
+            ArgumentParser& parse_stats_flag(std::string flag);
+
+            //Returns the statistics of the last parse (or nullptr if they were not collected).
+            //The parse_events() of a frozen parser may be concurrent, so do not update them
+            //(though they are still printed if the parse statistics flag is specified)
+            const ParseStats* parse_stats() const;
+
+            //Sets the number of threads which run asynchronous conversions (those of converters whose
+            //from_str() returns a std::future). Defaults to the number of hardware threads
+            ArgumentParser& async_conversion_threads(size_t num_threads);
+
+            //Prints the statistics of the last parse
+            void print_parse_stats();
+
             //Reset the target values to their initial state
             void reset_destinations();
 
+            //Returns a copy of the values of all destinations (including those of constructed sub-command parsers)
+            Snapshot snapshot() const;
+
+            //Returns a minimal command-line (starting with program) which reproduces the current
+            //destinations: only values with SPECIFIED provenance are included, converted with each
+            //argument's converter. Positional arguments come first, followed by the options (and '--'
+            //if the last takes multiple values, so they end before any sub-command).
+            //Throws ArgParseError if a value would be parsed as an option
+            CommandLine serialize_args(const std::string& program) const;
+
+            //Sets all destinations back to the values in snapshot (which must come from this parser).
+            //The parse state is also restored, so a following reparse_args_throw() can be incremental
+            void restore(const Snapshot& snapshot);
+
             //Prints the basic usage
             void print_usage();
 
@@ -98,27 +492,232 @@ namespace argparse {
             std::string epilog() const;
 
             //Returns all the argument groups in this parser
-            std::vector<ArgumentGroup> argument_groups() const;
+            const std::vector<ArgumentGroup>& argument_groups() const;
+
+            //Returns the argument with the specified ID
+            const Argument& argument(ArgumentId id) const;
+
+            //Returns the name of the argument which set value (or an empty string if none)
+            template<typename T>
+            const std::string& argument_name(const ArgValue<T>& value) const;
+
+            //Returns the group of the argument which set value (or an empty string if none)
+            template<typename T>
+            const std::string& argument_group(const ArgValue<T>& value) const;
+
+            //Returns the names of the registered sub-commands
+            std::vector<std::string> subcommands() const;
+
+            //Returns the help text of the named sub-command
+            std::string subcommand_help(const std::string& name) const;
+
+            //Returns the sub-command selected by the last parse (or an empty string if none)
+            std::string selected_subcommand() const;
+
+            //Returns the parser of the sub-command selected by the last parse (or nullptr if none)
+            ArgumentParser* selected_subparser() const;
+
+            //Returns the parser of the sub-command selected by the last parse, recursively
+            //(or this parser if no sub-command was selected)
+            ArgumentParser& active_parser();
+
+            //Returns a hash of the parser's definition (arguments, their types, converters,
+            //options and defaults, and sub-commands)
+            uint64_t fingerprint() const;
+
+            //Returns a stable hash of the converted values of this parser's arguments (excluding those
+            //removed with Argument::in_config_fingerprint(false), and any sub-command's arguments).
+            //Only arguments whose destinations changed since the last call are re-hashed
+            //(see Argument::value_fingerprint())
+            uint64_t config_fingerprint() const;
+
+            //Allows at most one of args (option strings, or positional argument names) to be specified.
+            //Constraints are checked after parsing, with all violations reported together.
+            //The arguments must already have been added: throws ArgParseError if any is unknown
+            ArgumentParser& mutually_exclusive(std::vector<std::string> args);
+
+            //Requires all of required_args to be specified whenever arg is
+            ArgumentParser& requires_arguments(std::string arg, std::vector<std::string> required_args);
+
+            //Requires at least one of args to be specified
+            ArgumentParser& at_least_one_of(std::vector<std::string> args);
+
+            //Returns the parser's definition (including those of its sub-commands, which are
+            //constructed if required), e.g. to save with ParserSchema::to_json()
+            ParserSchema schema();
 
         private:
             void add_help_option_if_unspecified();
 
-            struct ShortArgInfo {
-                bool is_no_space_short_arg = false;
-                std::shared_ptr<argparse::Argument> arg;
-                std::string value;
+            class StateBuilder;
+            class RequiredTracker;
+            class ParseTokenSource;
+            class ParserArguments;
+            class HandlerTokenResolver;
+
+            //Determines which arguments are specified by tokens (all of which are read), checking
+            //they are well formed. state.args_ must record the tokens as they are read
+            void resolve_args(TokenSource& tokens, ParseState& state);
+
+            //Sets the destinations as tokens are read, without recording them (see record_parse_state()),
+            //including those of any sub-command, and checks all required arguments were specified
+            void stream_args(TokenSource& tokens);
+
+            //Reports the arguments specified by tokens to handler, including those of
+            //any sub-command, and checks all required arguments were specified.
+            //Statistics are collected in stats (if non-null)
+            void resolve_events(TokenSource& tokens, ParseHandler& handler, ParseStats* stats);
+
+            //Reports the arguments specified by tokens to handler.
+            //Stops after a sub-command, returning its index (or -1 if there was none)
+            int resolve_tokens(TokenSource& tokens, ParseHandler& handler, ParseStats* stats);
+
+            //Adds the option strings and positional arguments of all arguments to options
+            void build_option_table(OptionTable& options) const;
+
+            //Sets the destinations as specified by state. If previous is non-null only the
+            //arguments which differ from previous are re-set
+            void apply_args(const ParseState& state, const ParseState* previous);
+
+            //An asynchronous conversion started by store_value()
+            struct PendingStore {
+                const Argument* arg;
+                std::function<void()> finish; //Waits for the conversion and sets the destination
+                size_t order; //Command-line order of the value
             };
-            ShortArgInfo no_space_short_arg(std::string str, const std::map<std::string, std::shared_ptr<Argument>>& str_to_option_arg) const;
+
+            //The earliest (in command-line order) conversion error of a parse
+            struct ConversionFailure {
+                size_t order = std::numeric_limits<size_t>::max(); //Of the value which failed to convert
+                std::string message;
+
+                //Records e (which occurred for arg) if it is earlier than any recorded so far
+                void record(const ArgumentParser& parser, const Argument& arg, size_t value_order, const ArgParseConversionError& e);
+                bool failed() const { return order != std::numeric_limits<size_t>::max(); }
+            };
+
+            //Completes the asynchronous conversions of pending_stores (setting their destinations), and then
+            //throws the earliest error of either them or failure (if any)
+            void finish_pending_stores(std::vector<PendingStore>& pending_stores, ConversionFailure& failure);
+
+            //Sets the destinations of the arguments in changed_args (indexed by ArgumentId) to their defaults,
+            //first resetting them if reset is true
+            void apply_defaults(const std::vector<bool>& changed_args, bool reset);
+
+            //Sets the destination for a single argument occurrence of state, stopping at the first
+            //value which fails to convert (which is recorded in failure)
+            void apply_occurrence(const ParseState& state, const ParseState::Occurrence& occurrence,
+                                  std::vector<PendingStore>* pending_stores, ConversionFailure& failure);
+
+            //Sets (or adds to) the destination of a positional argument
+            void apply_positional_value(Argument& arg, const std::string& value);
+
+            //Sets (or adds to) the destination of arg from value. If arg's converter is asynchronous and
+            //pending_stores is non-null the conversion is only started, and added to pending_stores
+            //(with order, the value's position on the command-line)
+            void store_value(Argument& arg, const std::string& value, std::vector<PendingStore>* pending_stores, size_t order);
+
+            //Returns e with the argument it occurred for appended
+            ArgParseConversionError annotate_conversion_error(const Argument& arg, const ArgParseConversionError& e) const;
+
+            //Returns the pool which runs asynchronous conversions (starting it if required)
+            ThreadPool& conversion_pool();
+
+            //Marks the value_fingerprint() of every argument as out of date
+            void invalidate_value_fingerprints();
+
+            //Checks all required arguments were specified by state
+            void check_required(const ParseState& state) const;
+            void check_required(const std::vector<bool>& specified_arguments, bool subcommand_selected) const;
+
+            //Returns the IDs of the arguments with the option strings (or positional names) names.
+            //Throws ArgParseError if any is not an argument of the parser
+            std::vector<ArgumentId> constraint_arguments(const std::vector<std::string>& names) const;
+
+            //Compiles the constraints between arguments into masks of their IDs (if changed since last compiled)
+            void compile_constraints();
+
+            //Checks the constraints between arguments are satisfied by specified_arguments
+            void check_constraints(const std::vector<bool>& specified_arguments) const;
+
+            //Returns true if any argument is chunked (see Argument::chunked())
+            bool has_chunked_arguments() const;
+
+            //Returns the parser of the indexed sub-command (constructing it if required)
+            ArgumentParser& subparser_for(int index);
+
+            //Returns the parse cache file for arg_strs (with this parser's fingerprint())
+            std::string parse_cache_file(uint64_t parser_fingerprint, const std::vector<std::string>& arg_strs) const;
+
+            //Sets the destinations from the parse cache, returning false if arg_strs is not cached
+            bool load_cached_parse(const std::vector<std::string>& arg_strs);
+
+            //Saves the destinations set by state to the parse cache (if they can be serialized)
+            void store_cached_parse(const ParseState& state) const;
+
+            //Returns the statistics to collect for a parse, if enabled (or if the parse statistics
+            //flag may be specified), or nullptr if none are collected
+            std::unique_ptr<ParseStats> start_parse_stats();
+
+            //Completes the statistics of a successful parse of num_tokens arguments, printing them if
+            //the parse statistics flag was specified. Unless keep is false they become parse_stats()
+            void finish_parse_stats(std::unique_ptr<ParseStats> stats, bool print_stats, size_t num_tokens, bool keep=true);
+
+            //Prints stats
+            void print_parse_stats(const ParseStats& stats);
+
+            //Appends the arguments which reproduce the current destinations to cmd_line
+            void append_specified_args(CommandLine& cmd_line) const;
+
+            //Returns 'did you mean' suggestions for an unrecognized option string
+            std::vector<std::string> suggest_options(const std::string& str, const std::map<std::string, ArgumentId>& str_to_option_arg) const;
         private:
             std::string prog_;
-            std::string description_;
-            std::string epilog_;
+            HelpText description_;
+            HelpText epilog_;
             std::string version_;
             std::vector<ArgumentGroup> argument_groups_;
 
+            std::shared_ptr<ArgumentTable> argument_table_; //Shared by all the parser's argument groups
             std::unique_ptr<Formatter> formatter_;
             std::ostream& os_;
             ArgValue<bool> show_help_dummy_; //Dummy variable used as destination for automatically generated help option
+
+            mutable SuggestionIndex option_index_; //Lazily built index of option strings for suggestions
+            mutable size_t option_index_size_ = 0; //Number of option strings indexed in option_index_
+
+            struct Subcommand {
+                std::string name;
+                std::string help;
+                SubparserFactory factory;
+                std::unique_ptr<ArgumentParser> parser; //Null until the sub-command is first used
+            };
+            std::vector<Subcommand> subcommands_;
+            bool subcommand_required_ = false;
+            int selected_subcommand_ = -1; //Index into subcommands_ of the sub-command selected by the last parse
+
+            std::string parse_cache_dir_; //Directory of the parse cache (disabled if empty)
+
+            bool collect_parse_stats_ = false;
+            AllocationCounter allocation_counter_;
+            std::string parse_stats_flag_; //Hidden option which prints the parse statistics (disabled if empty)
+            std::unique_ptr<ParseStats> parse_stats_; //Statistics of the last parse (null if not collected)
+
+            size_t async_conversion_threads_ = 0; //Zero for the number of hardware threads
+            std::unique_ptr<ThreadPool> conversion_pool_; //Null until an asynchronous conversion is started
+
+            struct CompiledConstraint {
+                ArgumentConstraint::Kind kind;
+                ArgumentId arg; //The requiring argument (REQUIRES only)
+                std::vector<uint64_t> mask; //Bit per ArgumentId of the constrained arguments
+            };
+            std::vector<CompiledConstraint> compiled_constraints_;
+            size_t compiled_num_constraints_ = 0; //Number of constraints when compiled_constraints_ was built
+            size_t compiled_num_arguments_ = 0; //Number of arguments when compiled_constraints_ was built
+
+            bool record_parse_state_ = false;
+            ParseState last_state_; //State of the last successful parse
+            size_t parse_generation_ = 0; //Incremented whenever the destinations are (re)set
     };
 
     class ArgumentGroup {
@@ -140,18 +739,34 @@ namespace argparse {
             template<typename T, typename Converter=DefaultConverter<T>>
             Argument& add_argument(ArgValue<std::vector<T>>& dest, std::string long_opt, std::string short_opt);
 
+            //Adds the arguments and options in specs, reserving their storage up front and validating
+            //each specification once. Throws ArgParseError (and adds none of the remaining specs) if a
+            //specification is invalid
+            ArgumentGroup& add_arguments(std::vector<ArgumentSpec> specs);
+
             //Adds an epilog to the group
             ArgumentGroup& epilog(std::string str);
+            ArgumentGroup& epilog(StaticText str);
+
+            //Allows at most one of the group's arguments to be specified
+            ArgumentGroup& mutually_exclusive();
+
+            //Requires at least one of the group's arguments to be specified
+            ArgumentGroup& at_least_one();
+
+            //Returns a stable hash of the converted values of the group's arguments
+            //(see ArgumentParser::config_fingerprint())
+            uint64_t config_fingerprint() const;
 
         public:
             //Returns the name of the group
-            std::string name() const;
+            const std::string& name() const;
 
             //Returns the epilog
             std::string epilog() const;
 
-            //Returns the arguments within the group
-            const std::vector<std::shared_ptr<Argument>>& arguments() const;
+            //Returns the arguments within the group (owned by the parser)
+            const std::vector<Argument*>& arguments() const;
         public:
             ArgumentGroup(const ArgumentGroup&) = default;
             ArgumentGroup(ArgumentGroup&&) = default;
@@ -159,20 +774,26 @@ namespace argparse {
             ArgumentGroup& operator=(const ArgumentGroup&&) = delete;
         private:
             friend class ArgumentParser;
-            ArgumentGroup(std::string name_str=std::string());
+            ArgumentGroup(std::string name_str, std::shared_ptr<ArgumentTable> argument_table);
         private:
-            std::string name_;
-            std::string epilog_;
-            std::vector<std::shared_ptr<Argument>> arguments_;
+            std::shared_ptr<ArgumentTable> argument_table_;
+            const std::string* name_;
+            HelpText epilog_;
+            std::vector<Argument*> arguments_;
     };
 
     class Argument {
         public:
-            Argument(std::string long_opt, std::string short_opt);
+            //Registers the argument in argument_table, which must out-live the argument.
+            //The destination dest is accessed through ops
+            Argument(ArgumentTable& argument_table, void* dest, const ValueOps* ops, std::string long_opt, std::string short_opt);
         public: //Configuration Mutators
             //Sets the hlep text
             Argument& help(std::string help_str);
 
+            //Sets the help text, which is referenced (rather than copied) until the help is printed
+            Argument& help(StaticText help_str);
+
             //Sets the defuault value
             Argument& default_value(const std::string& default_val);
             Argument& default_value(const std::vector<std::string>& default_val);
@@ -193,42 +814,85 @@ namespace argparse {
             //Sets the valid choices for this option's value
             Argument& choices(std::vector<std::string> choice_values);
 
+            //Sets the separator of a delimited list value (e.g. ',' for '--weights 0.1,0.2,0.3').
+            //Each value is split on delimiter, and every field converted into the (multi value) destination.
+            //Delimited values can not be restricted to choices
+            Argument& delimiter(char delim);
+
             //Sets the group name this argument is associated with
             Argument& group_name(std::string grp);
 
             //Sets where this option appears in the help
             Argument& show_in(ShowIn show);
 
+            //Passes the values of a multi value (nargs '+' or '*') positional argument to callback
+            //in chunks of chunk_size values as they are parsed (with any remainder at the end of the
+            //parse), rather than accumulating them all in the destination. T must be the
+            //destination's element type (e.g. std::string for an ArgValue<std::vector<std::string>>).
+            //Chunks already passed to callback are not withdrawn if the parse later fails
+            template<typename T>
+            Argument& chunked(size_t chunk_size, std::function<void(std::vector<T>& chunk)> callback);
+
+            //Remembers the conversions (values or errors) of up to max_entries distinct values (the most
+            //recently used), so values repeated within or across parses are not converted again.
+            //The memo is held by the parser, persists across its parses, and may be shared by the
+            //concurrent parses of a frozen parser (see ArgumentParser::freeze()). Zero disables it.
+            //Delimited lists and asynchronous conversions are not memoized
+            Argument& memoize(size_t max_entries);
+
+            //Sets whether the argument's value contributes to the configuration fingerprint
+            //(see ArgumentParser::config_fingerprint()). Exclude arguments which do not affect
+            //results, such as verbosity
+            Argument& in_config_fingerprint(bool included);
+
         public: //Option setting mutators
             //Sets the target value to the specified default
-            virtual void set_dest_to_default() = 0;
+            void set_dest_to_default();
 
             //Sets the target value to the specified value
-            virtual void set_dest_to_value(std::string value) = 0;
+            void set_dest_to_value(const std::string& value);
 
             //Adds the specified value to the taget values
-            virtual void add_value_to_dest(std::string value) = 0;
+            void add_value_to_dest(const std::string& value);
 
             //Set the target value to true
-            virtual void set_dest_to_true() = 0;
+            void set_dest_to_true();
 
             //Set the target value to false
-            virtual void set_dest_to_false() = 0;
+            void set_dest_to_false();
+
+            //Resets the target value to its initial state
+            void reset_dest();
+
+            //Passes the values accumulated in a chunked target to its callback, if a full chunk
+            //has accumulated (or any values, if final is true)
+            void flush_dest_chunk(bool final);
 
-            virtual void reset_dest() = 0;
+            //Returns the address of the target value
+            const void* destination() const;
+            void* destination();
+
+            //Returns the operations on the target value
+            const ValueOps& value_ops() const;
+
+            //Returns the memo of the argument's conversions (or nullptr if not memoized)
+            ConversionMemoBase* conversion_memo() const;
         public: //Accessors
 
+            //Returns the ID of this argument within its parser
+            ArgumentId id() const;
+
             //Returns a discriptive name build from the long/short option
-            std::string name() const;
+            const std::string& name() const;
 
             //Returns the long option name (or positional name) for this argument.
             //Note that this may be a single-letter option if only a short option name was specified
-            std::string long_option() const;
+            const std::string& long_option() const;
 
             //Returns the short option name for this argument, note that this returns
             //the empty string if no short option is specified, or if only the short option
             //is specified.
-            std::string short_option() const;
+            const std::string& short_option() const;
 
             //Returns the help description for this option
             std::string help() const;
@@ -237,10 +901,13 @@ namespace argparse {
             char nargs() const;
 
             //Returns the specified metavar for this option
-            std::string metavar() const;
+            const std::string& metavar() const;
 
             //Returns the list of valid choices for this option
-            std::vector<std::string> choices() const;
+            const std::vector<std::string>& choices() const;
+
+            //Returns the separator of a delimited list value (or '\0' if values are not split)
+            char delimiter() const;
 
             //Returns the action associated with this option
             Action action() const;
@@ -252,7 +919,7 @@ namespace argparse {
             std::string default_value() const;
 
             //Returns the group name associated with this argument
-            std::string group_name() const;
+            const std::string& group_name() const;
 
             //Indicates where this option should appear in the help
             ShowIn show_in() const;
@@ -263,253 +930,76 @@ namespace argparse {
             //Returns true if the default_value() was set
             bool default_set() const;
 
+            //Returns true if the values are passed to a callback in chunks (see chunked())
+            bool is_chunked() const;
+
+            //Returns the hit/miss counts of the argument's conversion memo (all zero if not memoized)
+            MemoStats memo_stats() const;
+
+            //Returns up to max_results valid choices close to value
+            std::vector<std::string> suggest_choices(const std::string& value, size_t max_results=3) const;
+
             //Returns true if the proposed value is legal
-            virtual bool is_valid_value(std::string value) = 0;
+            bool is_valid_value(const std::string& value) const;
+
+            //Returns the specified default value(s)
+            const std::vector<std::string>& default_values() const;
+
+            //Returns whether the argument's value contributes to the configuration fingerprint
+            bool in_config_fingerprint() const;
+
+            //Returns a stable hash of the option and its converted value(s), recomputed only if the
+            //destination was changed (by the parser) since it was last computed. Throws ArgParseError
+            //if the converter has no to_str() to put the value in canonical form
+            uint64_t value_fingerprint() const;
+
+            //Marks the value_fingerprint() as out of date. Call after modifying the destination
+            //directly (rather than through the parser), or through another argument sharing it
+            void value_changed();
+
+            //Returns the name of the argument with the specified ID (within the same parser)
+            const std::string& argument_name(ArgumentId id) const;
         public: //Lifetime
-            virtual ~Argument() {}
-            Argument(const Argument&) = default;
-            Argument(Argument&&) = default;
+            //Arguments are owned by their parser's ArgumentTable, and are not copied
+            ~Argument() = default;
+            Argument(const Argument&) = delete;
+            Argument(Argument&&) = delete;
             Argument& operator=(const Argument&) = delete;
             Argument& operator=(const Argument&&) = delete;
-        protected:
-            virtual bool valid_action() = 0;
-            std::vector<std::string> default_value_;
-        private: //Data
-            std::string long_opt_;
-            std::string short_opt_;
+        private:
+            friend class ArgumentGroup;
 
-            std::string help_;
-            std::string metavar_;
-            char nargs_ = '1';
-            std::vector<std::string> choices_;
-            Action action_ = Action::STORE;
-            bool required_ = false;
+            //Completes the inferred fields of spec (nargs and choices), and checks the whole
+            //specification is valid, so it can be applied by configure() without failing
+            static void check_spec(ArgumentSpec& spec);
 
+            //Applies the configuration in spec (already checked by check_spec())
+            void configure(ArgumentSpec&& spec);
 
-            std::string group_name_;
-            ShowIn show_in_ = ShowIn::USAGE_AND_HELP;
-            bool default_set_ = false;
-    };
+            //Checks the long/short option names are well formed
+            static void check_option_names(const std::string& long_opt, const std::string& short_opt);
 
-    template<typename T, typename Converter>
-    class SingleValueArgument : public Argument {
-        public: //Constructors
-            SingleValueArgument(ArgValue<T>& dest, std::string long_opt, std::string short_opt)
-                : Argument(long_opt, short_opt)
-                , dest_(dest)
-                {}
-        public: //Mutators
-            void set_dest_to_default() override {
-                dest_.set(Converter().from_str(default_value()), Provenance::DEFAULT);
-                dest_.set_argument_name(name());
-                dest_.set_argument_group(group_name());
-            }
-
-            void set_dest_to_value(std::string value) override {
-                if (dest_.provenance() == Provenance::SPECIFIED
-                    && dest_.argument_name() == name()) {
-                    throw ArgParseError("Argument " + name() + " specified multiple times");
-                }
-
-                dest_.set(Converter().from_str(value), Provenance::SPECIFIED);
-                dest_.set_argument_name(name());
-                dest_.set_argument_group(group_name());
-            }
-
-            void add_value_to_dest(std::string /*value*/) override {
-                throw ArgParseError("Single value option can not have multiple values set");
-            }
-
-            void set_dest_to_true() override {
-                throw ArgParseError("Non-boolean destination can not be set true");
-            }
-            void set_dest_to_false() override {
-                throw ArgParseError("Non-boolean destination can not be set false");
-            }
-
-            bool valid_action() override {
-                //Sanity check that we aren't processing a boolean action with a non-boolean destination
-                if (action() == Action::STORE_TRUE) {
-                    std::stringstream msg;
-                    msg << "Non-boolean destination can not have STORE_TRUE action (" << long_option() << ")";
-                    throw ArgParseError(msg.str());
-                } else if (action() == Action::STORE_FALSE) {
-                    std::stringstream msg;
-                    msg << "Non-boolean destination can not have STORE_FALSE action (" << long_option() << ")";
-                    throw ArgParseError(msg.str());
-                } else if (action() != Action::STORE) {
-                    throw ArgParseError("Unexpected action (expected STORE)");
-                }
-                return true;
-            }
-
-            void reset_dest() override {
-                dest_ = ArgValue<T>();
-            }
-
-            bool is_valid_value(std::string value) override {
-                auto converted_value = Converter().from_str(value);
-
-                if (!converted_value) {
-                    return false;
-                }
-                return is_valid_choice(value, choices());
-            }
+            //Checks nargs_type is consistent with action_type
+            static void check_nargs(Action action_type, char nargs_type);
 
-        private: //Data
-            ArgValue<T>& dest_;
-    };
+            //Checks action_type is supported by a destination of the specified kind
+            static void check_action(ValueOps::Kind kind, Action action_type, const std::string& long_opt);
 
-    //bool specialization for STORE_TRUE/STORE_FALSE
-    template<typename Converter>
-    class SingleValueArgument<bool,Converter> : public Argument {
-        public: //Constructors
-            SingleValueArgument(ArgValue<bool>& dest, std::string long_opt, std::string short_opt)
-                : Argument(long_opt, short_opt)
-                , dest_(dest)
-                {}
-        public: //Mutators
-            void set_dest_to_default() override {
-                dest_.set(Converter().from_str(default_value()), Provenance::DEFAULT);
-                dest_.set_argument_name(name());
-                dest_.set_argument_group(group_name());
-            }
-
-            void add_value_to_dest(std::string /*value*/) override {
-                throw ArgParseError("Single value option can not have multiple values set");
-            }
-
-            void set_dest_to_value(std::string value) override {
-                if (dest_.provenance() == Provenance::SPECIFIED
-                    && dest_.argument_name() == name()) {
-                    throw ArgParseError("Argument " + name() + " specified multiple times");
-                }
-
-                dest_.set(Converter().from_str(value), Provenance::SPECIFIED);
-                dest_.set_argument_name(name());
-                dest_.set_argument_group(group_name());
-            }
-
-            void set_dest_to_true() override {
-                ConvertedValue<bool> val;
-                val.set_value(true);
-
-                dest_.set(val, Provenance::SPECIFIED);
-                dest_.set_argument_name(name());
-                dest_.set_argument_group(group_name());
-            }
-
-            void set_dest_to_false() override {
-                ConvertedValue<bool> val;
-                val.set_value(false);
-
-                dest_.set(val, Provenance::SPECIFIED);
-                dest_.set_argument_name(name());
-                dest_.set_argument_group(group_name());
-            }
-
-            bool valid_action() override { 
-                //Any supported action is valid on a boolean destination
-                return true; 
-            }
-
-            void reset_dest() override {
-                dest_ = ArgValue<bool>();
-            }
-
-            bool is_valid_value(std::string value) override {
-                auto converted_value = Converter().from_str(value);
-
-                if (!converted_value) {
-                    return false;
-                }
-                return is_valid_choice(value, choices());
-            }
-        private: //Data
-            ArgValue<bool>& dest_;
-    };
+            //Checks the action is supported by the destination type
+            void valid_action() const;
 
-    template<typename T, typename Converter>
-    class MultiValueArgument : public Argument {
-        public: //Constructors
-            MultiValueArgument(ArgValue<T>& dest, std::string long_opt, std::string short_opt)
-                : Argument(long_opt, short_opt)
-                , dest_(dest)
-                {}
-
-        public: //Mutators
-            void set_dest_to_default() override {
-                auto& target = dest_.mutable_value(Provenance::DEFAULT);
-                for (auto default_str : default_value_) {
-                    auto val = Converter().from_str(default_str);
-                    target.insert(std::end(target), val.value());
-                }
-
-                dest_.set_argument_name(name());
-                dest_.set_argument_group(group_name());
-            }
-
-            void set_dest_to_value(std::string /*value*/) override {
-                throw ArgParseError("Multi-value option can not be set to a single value");
-            }
-
-            void add_value_to_dest(std::string value) override {
-                if (dest_.provenance() == Provenance::SPECIFIED
-                    && dest_.argument_name() != name()) {
-                    throw ArgParseError("Argument destination already set by " + dest_.argument_name() + " (trying to set from " + name() + ")");
-                }
-
-                auto previous_provenance = dest_.provenance();
-
-                auto& target = dest_.mutable_value(Provenance::SPECIFIED);
-
-                if (previous_provenance == Provenance::DEFAULT) {
-                    target.clear();
-                }
-
-                //Insert is more general than push_back
-                auto converted_value = Converter().from_str(value);
-                if (!converted_value) {
-                    throw ArgParseConversionError(converted_value.error());
-                }
-                target.insert(std::end(target), converted_value.value());
-
-                dest_.set_argument_name(name());
-                dest_.set_argument_group(group_name());
-            }
-
-            void set_dest_to_true() override {
-                throw ArgParseError("Non-boolean destination can not be set true");
-            }
-            void set_dest_to_false() override {
-                throw ArgParseError("Non-boolean destination can not be set false");
-            }
-
-            bool valid_action() override {
-                //Sanity check that we aren't processing a boolean action with a non-boolean destination
-                if (action() != Action::STORE) {
-                    throw ArgParseError("Unexpected action (expected STORE)");
-                }
-                return true;
-            }
-
-            void reset_dest() override {
-                dest_ = ArgValue<T>();
-            }
-
-            bool is_valid_value(std::string value) override {
-                auto converted_value = Converter().from_str(value);
-
-                if (!converted_value) {
-                    return false;
-                }
-                return is_valid_choice(value, choices());
-            }
+            ArgumentHot& hot();
+            const ArgumentHot& hot() const;
+            ArgumentCold& cold();
+            const ArgumentCold& cold() const;
         private: //Data
-            ArgValue<T>& dest_;
+            //All other argument data is stored in the parser's argument table
+            ArgumentTable* argument_table_;
+            ArgumentId id_;
+            void* dest_; //The ArgValue<T> set by this argument
+            const ValueOps* ops_; //Shared by all arguments of the same type (see make_value_ops())
     };
 
-
 } //namespace
 
 #include "argparse.tpp"
@@ -1,34 +1,511 @@
+#include <future>
+#include <memory>
+#include <new>
 #include <sstream>
+#include <type_traits>
+#include <utility>
+#include "argparse_cache.hpp"
 #include "argparse_util.hpp"
 
 namespace argparse {
 
+    /*
+     * ValueOps implementations
+     */
+    //Detects whether Converter's from_str() returns a std::future (i.e. converts asynchronously)
+    template<typename Result>
+    struct IsFuture : std::false_type {};
+
+    template<typename T>
+    struct IsFuture<std::future<T>> : std::true_type {};
+
+    template<typename Converter>
+    struct IsAsyncConverter : IsFuture<decltype(std::declval<Converter&>().from_str(std::declval<std::string>()))> {};
+
+    //Returns the result of a converter's from_str(), which may be a ConvertedValue or a std::future of one
+    //(which is waited for)
+    template<typename T>
+    ConvertedValue<T> from_str_result(ConvertedValue<T> converted_value) {
+        return converted_value;
+    }
+
+    template<typename T>
+    ConvertedValue<T> from_str_result(std::future<ConvertedValue<T>> future) {
+        return future.get();
+    }
+
+    //Detects whether Converter can convert a character range directly (see DefaultConverter)
+    template<typename Converter, typename Enable=void>
+    struct HasRangeFromStr : std::false_type {};
+
+    template<typename Converter>
+    struct HasRangeFromStr<Converter,decltype(void(std::declval<Converter&>().from_str(std::declval<const char*>(), std::declval<const char*>())))> : std::true_type {};
+
+    //Converts the characters [begin, end), without constructing a string if the converter supports it
     template<typename T, typename Converter>
-    std::shared_ptr<Argument> make_singlevalue_argument(ArgValue<T>& dest, std::string long_opt, std::string short_opt) {
-        auto ptr = std::make_shared<SingleValueArgument<T, Converter>>(dest, long_opt, short_opt);
+    typename std::enable_if<HasRangeFromStr<Converter>::value, ConvertedValue<T>>::type
+    convert_field(const char* begin, const char* end, std::string& /*scratch*/) {
+        return Converter().from_str(begin, end);
+    }
 
-        //If the conversion object specifies a non-empty set of choices
-        //use those by default
-        auto default_choices = Converter().default_choices();
-        if (!default_choices.empty()) {
-            ptr->choices(default_choices);
+    template<typename T, typename Converter>
+    typename std::enable_if<!HasRangeFromStr<Converter>::value, ConvertedValue<T>>::type
+    convert_field(const char* begin, const char* end, std::string& scratch) {
+        scratch.assign(begin, end); //Re-uses scratch's storage
+        return from_str_result(Converter().from_str(scratch));
+    }
+
+    //Converts value, without copying it if the converter supports character ranges
+    template<typename T, typename Converter>
+    typename std::enable_if<HasRangeFromStr<Converter>::value, ConvertedValue<T>>::type
+    convert_str(const std::string& value) {
+        return Converter().from_str(value.data(), value.data() + value.size());
+    }
+
+    template<typename T, typename Converter>
+    typename std::enable_if<!HasRangeFromStr<Converter>::value, ConvertedValue<T>>::type
+    convert_str(const std::string& value) {
+        return from_str_result(Converter().from_str(value));
+    }
+
+    //Converts value for arg, re-using the result remembered in arg's conversion memo (if any)
+    template<typename T, typename Converter>
+    ConvertedValue<T> convert_value(const Argument& arg, const std::string& value) {
+        //The memo was made by make_memo<T>() (see Argument::memoize())
+        auto memo = static_cast<ConversionMemo<T>*>(arg.conversion_memo());
+        if (!memo) {
+            return convert_str<T,Converter>(value);
+        }
+
+        ConvertedValue<T> converted_value;
+        if (!memo->find(value, converted_value)) {
+            converted_value = convert_str<T,Converter>(value);
+            memo->insert(value, converted_value);
+        }
+        return converted_value;
+    }
+
+    template<typename T, typename Converter>
+    bool is_convertible_value(const Argument& arg, const std::string& value) {
+        return convert_value<T,Converter>(arg, value).valid();
+    }
+
+    //Accepts any value, as waiting for an asynchronous conversion would serialize the parse.
+    //Invalid values are instead reported when the conversion completes
+    inline bool is_convertible_deferred(const Argument& /*arg*/, const std::string& /*value*/) {
+        return true;
+    }
+
+    //Returns the message of a conversion error in the index'th field of a delimited list
+    inline std::string field_error(const std::string& error, size_t index) {
+        std::stringstream msg;
+        msg << error << " (field " << index + 1 << ")";
+        return msg.str();
+    }
+
+    template<typename T, typename Converter>
+    bool is_convertible_fields(const std::string& value, char delimiter, std::string* error) {
+        std::string scratch;
+        return for_each_field(value, delimiter, [&](const char* begin, const char* end, size_t index) {
+            auto converted_value = convert_field<T,Converter>(begin, end, scratch);
+            if (!converted_value && error) {
+                *error = field_error(converted_value.error(), index);
+            }
+            return converted_value.valid();
+        });
+    }
+
+    //Appends the values converted from each field of str (separated by delimiter) to values
+    template<typename T, typename Converter>
+    void append_field_values(std::vector<T>& values, const std::string& str, char delimiter) {
+        std::string scratch;
+        for_each_field(str, delimiter, [&](const char* begin, const char* end, size_t index) {
+            auto converted_value = convert_field<T,Converter>(begin, end, scratch);
+            if (!converted_value) {
+                throw ArgParseConversionError(field_error(converted_value.error(), index));
+            }
+            values.insert(std::end(values), converted_value.value());
+            return true;
+        });
+    }
+
+    template<typename T, typename Converter>
+    void set_single_value_to_default(const Argument& arg, void* dest) {
+        auto& target = *static_cast<ArgValue<T>*>(dest);
+        target.set(convert_value<T,Converter>(arg, arg.default_value()), Provenance::DEFAULT);
+        target.set_argument_id(arg.id());
+    }
+
+    //Sets dest to a value specified by arg
+    template<typename T>
+    void set_single_value(const Argument& arg, void* dest, ConvertedValue<T> converted_value) {
+        auto& target = *static_cast<ArgValue<T>*>(dest);
+        if (target.provenance() == Provenance::SPECIFIED
+            && target.argument_id() == arg.id()) {
+            throw ArgParseError("Argument " + arg.name() + " specified multiple times");
+        }
+
+        target.set(converted_value, Provenance::SPECIFIED);
+        target.set_argument_id(arg.id());
+    }
+
+    template<typename T, typename Converter>
+    void store_single_value(const Argument& arg, void* dest, const std::string& value) {
+        set_single_value<T>(arg, dest, convert_value<T,Converter>(arg, value));
+    }
+
+    template<typename T, typename Converter>
+    void set_multi_value_to_default(const Argument& arg, void* dest) {
+        auto& target = *static_cast<ArgValue<T>*>(dest);
+        auto& values = target.mutable_value(Provenance::DEFAULT);
+        for (const auto& default_str : arg.default_values()) {
+            if (arg.delimiter()) {
+                append_field_values<typename T::value_type,Converter>(values, default_str, arg.delimiter());
+                continue;
+            }
+            auto val = convert_value<typename T::value_type,Converter>(arg, default_str);
+            values.insert(std::end(values), val.value());
+        }
+
+        target.set_argument_id(arg.id());
+    }
+
+    //Returns the values of dest, to which values specified by arg are appended (discarding any defaults)
+    template<typename T>
+    T& specified_values(const Argument& arg, void* dest) {
+        auto& target = *static_cast<ArgValue<T>*>(dest);
+        if (target.provenance() == Provenance::SPECIFIED
+            && target.argument_id() != arg.id()) {
+            throw ArgParseError("Argument destination already set by " + arg.argument_name(target.argument_id()) + " (trying to set from " + arg.name() + ")");
+        }
+
+        auto previous_provenance = target.provenance();
+
+        auto& values = target.mutable_value(Provenance::SPECIFIED);
+
+        if (previous_provenance == Provenance::DEFAULT) {
+            values.clear();
+        }
+
+        target.set_argument_id(arg.id());
+        return values;
+    }
+
+    template<typename T>
+    void append_value(T& values, ConvertedValue<typename T::value_type> converted_value) {
+        if (!converted_value) {
+            throw ArgParseConversionError(converted_value.error());
+        }
+        //Insert is more general than push_back
+        values.insert(std::end(values), converted_value.value());
+    }
+
+    template<typename T, typename Converter>
+    void store_multi_value(const Argument& arg, void* dest, const std::string& value) {
+        auto& values = specified_values<T>(arg, dest);
+
+        if (arg.delimiter()) {
+            append_field_values<typename T::value_type,Converter>(values, value, arg.delimiter());
+        } else {
+            append_value(values, convert_value<typename T::value_type,Converter>(arg, value));
+        }
+    }
+
+    //Waits for future on pool (which runs it, if deferred), returning a function which
+    //then passes its result to store
+    template<typename Future, typename Store>
+    std::function<void()> start_async_store(Future future, ThreadPool& pool, Store store) {
+        auto result = std::make_shared<Future>(std::move(future));
+        std::shared_future<void> ready = pool.submit([result] { result->wait(); }).share();
+        return [result, ready, store] {
+            ready.wait();
+            store(result->get());
+        };
+    }
+
+    template<typename T, typename Converter>
+    std::function<void()> start_store_single_value(const Argument& arg, void* dest, const std::string& value, ThreadPool& pool) {
+        return start_async_store(Converter().from_str(value), pool, [&arg, dest](ConvertedValue<T> converted_value) {
+            set_single_value<T>(arg, dest, converted_value);
+        });
+    }
+
+    template<typename T, typename Converter>
+    std::function<void()> start_store_multi_value(const Argument& arg, void* dest, const std::string& value, ThreadPool& pool) {
+        return start_async_store(Converter().from_str(value), pool, [&arg, dest](ConvertedValue<typename T::value_type> converted_value) {
+            append_value(specified_values<T>(arg, dest), converted_value);
+        });
+    }
+
+    typedef std::function<void()> (*StartStoreFunction)(const Argument&, void*, const std::string&, ThreadPool&);
+
+    template<typename T, typename Converter>
+    typename std::enable_if<IsAsyncConverter<Converter>::value, StartStoreFunction>::type
+    start_store_single_function() { return &start_store_single_value<T,Converter>; }
+
+    template<typename T, typename Converter>
+    typename std::enable_if<!IsAsyncConverter<Converter>::value, StartStoreFunction>::type
+    start_store_single_function() { return nullptr; }
+
+    template<typename T, typename Converter>
+    typename std::enable_if<IsAsyncConverter<Converter>::value, StartStoreFunction>::type
+    start_store_multi_function() { return &start_store_multi_value<T,Converter>; }
+
+    template<typename T, typename Converter>
+    typename std::enable_if<!IsAsyncConverter<Converter>::value, StartStoreFunction>::type
+    start_store_multi_function() { return nullptr; }
+
+    template<typename T>
+    void reset_value(void* dest) {
+        *static_cast<ArgValue<T>*>(dest) = ArgValue<T>();
+    }
+
+    template<typename T>
+    void save_value(void* storage, const void* dest) {
+        new (storage) ArgValue<T>(*static_cast<const ArgValue<T>*>(dest));
+    }
+
+    template<typename T>
+    void load_value(void* dest, const void* storage) {
+        *static_cast<ArgValue<T>*>(dest) = *static_cast<const ArgValue<T>*>(storage);
+    }
+
+    template<typename T>
+    void destroy_value(void* storage) {
+        static_cast<ArgValue<T>*>(storage)->~ArgValue<T>();
+    }
+
+    template<typename T>
+    void serialize_value(const void* dest, std::string& out) {
+        const auto& value = *static_cast<const ArgValue<T>*>(dest);
+        ValueSerializer<T>::write(value.value(), out);
+        ValueSerializer<uint8_t>::write(uint8_t(value.provenance()), out);
+        ValueSerializer<ArgumentId>::write(value.argument_id(), out);
+    }
+
+    template<typename T>
+    bool deserialize_value(void* dest, const char*& data, const char* end) {
+        T value = T();
+        uint8_t provenance = 0;
+        ArgumentId argument_id = NO_ARGUMENT_ID;
+        if (!ValueSerializer<T>::read(data, end, value)
+            || !ValueSerializer<uint8_t>::read(data, end, provenance)
+            || !ValueSerializer<ArgumentId>::read(data, end, argument_id)
+            || provenance > uint8_t(Provenance::INFERRED)) {
+            return false;
         }
 
-        return ptr;
+        if (dest) {
+            auto& target = *static_cast<ArgValue<T>*>(dest);
+            target.set(value, Provenance(provenance));
+            target.set_argument_id(argument_id);
+        }
+        return true;
+    }
+
+    template<typename T>
+    typename std::enable_if<ValueSerializer<T>::supported, void (*)(const void*, std::string&)>::type
+    serialize_function() { return &serialize_value<T>; }
+
+    template<typename T>
+    typename std::enable_if<!ValueSerializer<T>::supported, void (*)(const void*, std::string&)>::type
+    serialize_function() { return nullptr; }
+
+    template<typename T>
+    typename std::enable_if<ValueSerializer<T>::supported, bool (*)(void*, const char*&, const char*)>::type
+    deserialize_function() { return &deserialize_value<T>; }
+
+    template<typename T>
+    typename std::enable_if<!ValueSerializer<T>::supported, bool (*)(void*, const char*&, const char*)>::type
+    deserialize_function() { return nullptr; }
+
+    template<typename T>
+    ArgumentId specified_by(const void* dest) {
+        const auto& value = *static_cast<const ArgValue<T>*>(dest);
+        if (value.provenance() != Provenance::SPECIFIED) {
+            return NO_ARGUMENT_ID;
+        }
+        return value.argument_id();
+    }
+
+    //Detects whether Converter has a to_str() accepting a T
+    template<typename Converter, typename T, typename Enable=void>
+    struct HasToStr : std::false_type {};
+
+    template<typename Converter, typename T>
+    struct HasToStr<Converter,T,decltype(void(std::declval<Converter&>().to_str(std::declval<T>())))> : std::true_type {};
+
+    //Returns the result of a converter's to_str(), which may be a ConvertedValue or a plain string
+    inline std::string to_str_result(ConvertedValue<std::string> converted_value) {
+        if (!converted_value) {
+            throw ArgParseConversionError(converted_value.error());
+        }
+        return converted_value.value();
+    }
+
+    inline std::string to_str_result(std::string str) {
+        return str;
     }
 
     template<typename T, typename Converter>
-    std::shared_ptr<Argument> make_multivalue_argument(ArgValue<T>& dest, std::string long_opt, std::string short_opt) {
-        auto ptr = std::make_shared<MultiValueArgument<T, Converter>>(dest, long_opt, short_opt);
+    void append_single_strs(const void* dest, CommandLine& out) {
+        const auto& value = *static_cast<const ArgValue<T>*>(dest);
+        out.push_back(to_str_result(Converter().to_str(value.value())));
+    }
+
+    template<typename T, typename Converter>
+    void append_multi_strs(const void* dest, CommandLine& out) {
+        const auto& values = *static_cast<const ArgValue<std::vector<T>>*>(dest);
+        for (const T& value : values.value()) {
+            out.push_back(to_str_result(Converter().to_str(value)));
+        }
+    }
+
+    template<typename T, typename Converter>
+    typename std::enable_if<HasToStr<Converter,T>::value, void (*)(const void*, CommandLine&)>::type
+    append_strs_function(bool multi) { return multi ? &append_multi_strs<T,Converter> : &append_single_strs<T,Converter>; }
+
+    template<typename T, typename Converter>
+    typename std::enable_if<!HasToStr<Converter,T>::value, void (*)(const void*, CommandLine&)>::type
+    append_strs_function(bool /*multi*/) { return nullptr; }
+
+    //Numeric values converted by the DefaultConverter can be checked by ParserSchema::validate()
+    template<typename T, typename Converter>
+    std::string schema_type() {
+        bool numeric = std::is_same<Converter,DefaultConverter<T>>::value
+                       && (std::is_floating_point<T>::value || (std::is_integral<T>::value && sizeof(T) > 1));
+        return numeric ? arg_type<T>() : std::string();
+    }
+
+    template<typename T>
+    std::unique_ptr<ConversionMemoBase> make_memo(size_t max_entries) {
+        return std::unique_ptr<ConversionMemoBase>(new ConversionMemo<T>(max_entries));
+    }
+
+    //Returns the operations for a single value destination (ArgValue<T>)
+    template<typename T, typename Converter>
+    const ValueOps* make_value_ops(ArgValue<T>& /*dest*/) {
+        static const ValueOps ops = {
+            std::is_same<T,bool>::value ? ValueOps::Kind::BOOL : ValueOps::Kind::SINGLE,
+            IsAsyncConverter<Converter>::value ? &is_convertible_deferred : &is_convertible_value<T,Converter>,
+            nullptr,
+            &set_single_value_to_default<T,Converter>,
+            &store_single_value<T,Converter>,
+            start_store_single_function<T,Converter>(),
+            &reset_value<T>,
+            sizeof(ArgValue<T>),
+            alignof(ArgValue<T>),
+            std::is_trivially_copyable<ArgValue<T>>::value,
+            &save_value<T>,
+            &load_value<T>,
+            &destroy_value<T>,
+            serialize_function<T>(),
+            deserialize_function<T>(),
+            &typeid(T),
+            &typeid(Converter),
+            &specified_by<T>,
+            append_strs_function<T,Converter>(false),
+            &schema_type<T,Converter>,
+            &make_memo<T>
+        };
+        return &ops;
+    }
+
+    //Returns the operations for a multi value destination (ArgValue<std::vector<T>>)
+    template<typename T, typename Converter>
+    const ValueOps* make_value_ops(ArgValue<std::vector<T>>& /*dest*/) {
+        static const ValueOps ops = {
+            ValueOps::Kind::MULTI,
+            IsAsyncConverter<Converter>::value ? &is_convertible_deferred : &is_convertible_value<T,Converter>,
+            &is_convertible_fields<T,Converter>,
+            &set_multi_value_to_default<std::vector<T>,Converter>,
+            &store_multi_value<std::vector<T>,Converter>,
+            start_store_multi_function<std::vector<T>,Converter>(),
+            &reset_value<std::vector<T>>,
+            sizeof(ArgValue<std::vector<T>>),
+            alignof(ArgValue<std::vector<T>>),
+            false,
+            &save_value<std::vector<T>>,
+            &load_value<std::vector<T>>,
+            &destroy_value<std::vector<T>>,
+            serialize_function<std::vector<T>>(),
+            deserialize_function<std::vector<T>>(),
+            &typeid(std::vector<T>),
+            &typeid(Converter),
+            &specified_by<std::vector<T>>,
+            append_strs_function<T,Converter>(true),
+            &schema_type<T,Converter>,
+            &make_memo<T>
+        };
+        return &ops;
+    }
+
+    template<typename Converter>
+    Argument& make_argument(ArgumentTable& argument_table, void* dest, const ValueOps* ops, std::string long_opt, std::string short_opt) {
+        auto& arg = argument_table.emplace<Argument>(argument_table, dest, ops, long_opt, short_opt);
 
         //If the conversion object specifies a non-empty set of choices
         //use those by default
         auto default_choices = Converter().default_choices();
         if (!default_choices.empty()) {
-            ptr->choices(default_choices);
+            arg.choices(default_choices);
+        }
+
+        return arg;
+    }
+
+    template<typename Converter>
+    std::vector<std::string> converter_default_choices() {
+        return Converter().default_choices();
+    }
+
+    template<typename T, typename Converter>
+    ArgumentSpec argument_spec(ArgValue<T>& dest, std::string long_opt, std::string short_opt) {
+        ArgumentSpec spec;
+        spec.dest = &dest;
+        spec.ops = make_value_ops<T,Converter>(dest);
+        spec.default_choices = &converter_default_choices<Converter>;
+        spec.long_opt = std::move(long_opt);
+        spec.short_opt = std::move(short_opt);
+        return spec;
+    }
+
+    template<typename T, typename Converter>
+    ArgumentSpec argument_spec(ArgValue<std::vector<T>>& dest, std::string long_opt, std::string short_opt) {
+        ArgumentSpec spec;
+        spec.dest = &dest;
+        spec.ops = make_value_ops<T,Converter>(dest);
+        spec.default_choices = &converter_default_choices<Converter>;
+        spec.long_opt = std::move(long_opt);
+        spec.short_opt = std::move(short_opt);
+        return spec;
+    }
+
+    /*
+     * Argument
+     */
+    template<typename T>
+    Argument& Argument::chunked(size_t chunk_size, std::function<void(std::vector<T>& chunk)> callback) {
+        if (!positional() || ops_->kind != ValueOps::Kind::MULTI) {
+            throw ArgParseError("Only multi value positional arguments can be chunked (" + name() + ")");
+        } else if (*ops_->value_type != typeid(std::vector<T>)) {
+            throw ArgParseError("Chunk type does not match the destination of " + name());
+        } else if (chunk_size == 0) {
+            throw ArgParseError("Chunk size must be non-zero (" + name() + ")");
         }
 
-        return ptr;
+        cold().flush_chunk = [chunk_size, callback](void* dest, bool final) {
+            auto& target = *static_cast<ArgValue<std::vector<T>>*>(dest);
+            if (target.value().size() < chunk_size && (!final || target.value().empty())) {
+                return;
+            }
+
+            auto& values = target.mutable_value(Provenance::SPECIFIED);
+            callback(values);
+            values.clear();
+        };
+        hot().set(ArgumentHot::CHUNKED, true);
+        return *this;
     }
 
     /*
@@ -54,6 +531,18 @@ namespace argparse {
     Argument& ArgumentParser::add_argument(ArgValue<std::vector<T>>& dest, std::string long_opt, std::string short_opt) {
         return argument_groups_[0].add_argument<T,Converter>(dest, long_opt, short_opt);
     }
+    template<typename T>
+    const std::string& ArgumentParser::argument_name(const ArgValue<T>& value) const {
+        if (value.argument_id() == NO_ARGUMENT_ID) return empty_string();
+        return argument(value.argument_id()).name();
+    }
+
+    template<typename T>
+    const std::string& ArgumentParser::argument_group(const ArgValue<T>& value) const {
+        if (value.argument_id() == NO_ARGUMENT_ID) return empty_string();
+        return argument(value.argument_id()).group_name();
+    }
+
     /*
      * ArgumentGroup
      */
@@ -64,7 +553,8 @@ namespace argparse {
 
     template<typename T, typename Converter>
     Argument& ArgumentGroup::add_argument(ArgValue<T>& dest, std::string long_opt, std::string short_opt) {
-        arguments_.push_back(make_singlevalue_argument<T,Converter>(dest, long_opt, short_opt));
+        auto ops = make_value_ops<T,Converter>(dest);
+        arguments_.push_back(&make_argument<Converter>(*argument_table_, &dest, ops, long_opt, short_opt));
 
         auto& arg = arguments_[arguments_.size() - 1];
         arg->group_name(name()); //Tag the option with the group
@@ -78,11 +568,37 @@ namespace argparse {
 
     template<typename T, typename Converter>
     Argument& ArgumentGroup::add_argument(ArgValue<std::vector<T>>& dest, std::string long_opt, std::string short_opt) {
-        arguments_.push_back(make_multivalue_argument<std::vector<T>,Converter>(dest, long_opt, short_opt));
+        auto ops = make_value_ops<T,Converter>(dest);
+        arguments_.push_back(&make_argument<Converter>(*argument_table_, &dest, ops, long_opt, short_opt));
 
         auto& arg = arguments_[arguments_.size() - 1];
         arg->group_name(name()); //Tag the option with the group
         return *arg;
     }
 
+    /*
+     * Explicit instantiations for common value types
+     *
+     * Adding an argument binds its destination to the (type-specific) operations in its ValueOps
+     * table. For the DefaultConverter of the common types these are instantiated once in the
+     * library (in src/instantiations, with single and multi values in separate translation units
+     * so a program only links those it uses), rather than in every translation unit which adds
+     * an argument.
+     */
+    #define ARGPARSE_SINGLE_VALUE_INSTANTIATIONS(EXTERN, T) \
+        EXTERN template const ValueOps* make_value_ops<T,DefaultConverter<T>>(ArgValue<T>&); \
+        EXTERN template Argument& make_argument<DefaultConverter<T>>(ArgumentTable&, void*, const ValueOps*, std::string, std::string);
+
+    #define ARGPARSE_MULTI_VALUE_INSTANTIATIONS(EXTERN, T) \
+        EXTERN template const ValueOps* make_value_ops<T,DefaultConverter<T>>(ArgValue<std::vector<T>>&);
+
+    #define ARGPARSE_EXTERN_VALUE_INSTANTIATIONS(T) \
+        ARGPARSE_SINGLE_VALUE_INSTANTIATIONS(extern, T) \
+        ARGPARSE_MULTI_VALUE_INSTANTIATIONS(extern, T)
+    ARGPARSE_NUMERIC_TYPES(ARGPARSE_EXTERN_VALUE_INSTANTIATIONS)
+    ARGPARSE_CHARACTER_TYPES(ARGPARSE_EXTERN_VALUE_INSTANTIATIONS)
+    ARGPARSE_EXTERN_VALUE_INSTANTIATIONS(std::string)
+    ARGPARSE_SINGLE_VALUE_INSTANTIATIONS(extern, bool)
+    #undef ARGPARSE_EXTERN_VALUE_INSTANTIATIONS
+
 } //namespace
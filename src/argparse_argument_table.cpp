@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <sstream>
+
+#include "argparse_argument_table.hpp"
+#include "argparse_error.hpp"
+#include "argparse.hpp"
+
+namespace argparse {
+
+    //Size of the blocks Argument objects are allocated from
+    constexpr size_t ARGUMENT_BLOCK_SIZE = 4096;
+
+    ArgumentTable::~ArgumentTable() {
+        for (Argument* arg : arguments_) {
+            arg->~Argument();
+        }
+    }
+
+    ArgumentId ArgumentTable::add(Argument* arg) {
+        check_not_frozen();
+        if (arguments_.size() >= NO_ARGUMENT_ID) {
+            std::stringstream msg;
+            msg << "Too many arguments (at most " << NO_ARGUMENT_ID << " are supported per parser)";
+            throw ArgParseError(msg.str());
+        }
+        arguments_.push_back(arg);
+        hot_.emplace_back();
+        cold_.emplace_back();
+        ArgumentId id = ArgumentId(arguments_.size() - 1);
+        cold_.back().next_same_dest = id;
+        destinations_linked_ = false;
+        return id;
+    }
+
+    void ArgumentTable::link_destinations() {
+        //Order the IDs by destination, so the arguments sharing one are adjacent
+        std::vector<ArgumentId> ids(arguments_.size());
+        std::iota(ids.begin(), ids.end(), ArgumentId(0));
+        std::stable_sort(ids.begin(), ids.end(), [&](ArgumentId lhs, ArgumentId rhs) {
+            return std::less<const void*>()(arguments_[lhs]->destination(), arguments_[rhs]->destination());
+        });
+
+        for (size_t begin = 0; begin < ids.size();) {
+            size_t end = begin + 1;
+            while (end < ids.size() && arguments_[ids[end]]->destination() == arguments_[ids[begin]]->destination()) {
+                ++end;
+            }
+            for (size_t i = begin; i < end; ++i) {
+                cold_[ids[i]].next_same_dest = ids[i + 1 < end ? i + 1 : begin];
+            }
+            begin = end;
+        }
+        destinations_linked_ = true;
+    }
+
+    void ArgumentTable::add_constraint(ArgumentConstraint constraint) {
+        check_not_frozen();
+        constraints_.push_back(std::move(constraint));
+    }
+
+    void ArgumentTable::check_not_frozen() const {
+        if (frozen_) {
+            throw ArgParseError("Can not modify the arguments of a frozen parser");
+        }
+    }
+
+    Argument& ArgumentTable::argument(ArgumentId id) const {
+        if (id >= arguments_.size()) {
+            std::stringstream msg;
+            msg << "Invalid argument ID " << id;
+            throw ArgParseError(msg.str());
+        }
+        return *arguments_[id];
+    }
+
+    size_t ArgumentTable::size() const { return arguments_.size(); }
+
+    void ArgumentTable::reserve(size_t num_args) {
+        arguments_.reserve(arguments_.size() + num_args);
+        hot_.reserve(hot_.size() + num_args);
+        cold_.reserve(cold_.size() + num_args);
+    }
+
+    StringPool& ArgumentTable::strings() { return strings_; }
+
+    void* ArgumentTable::allocate(size_t size) {
+        //Keep every object suitably aligned
+        constexpr size_t align = alignof(std::max_align_t);
+        size = (size + align - 1) / align * align;
+
+        if (blocks_.empty() || block_used_ + size > block_size_) {
+            block_size_ = std::max(ARGUMENT_BLOCK_SIZE, size);
+            blocks_.emplace_back(new char[block_size_]);
+            block_used_ = 0;
+        }
+
+        void* storage = blocks_.back().get() + block_used_;
+        block_used_ += size;
+        return storage;
+    }
+
+    void ArgumentTable::remove_last() {
+        arguments_.pop_back();
+        hot_.pop_back();
+        cold_.pop_back();
+    }
+
+} //namespace
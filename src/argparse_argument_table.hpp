@@ -0,0 +1,208 @@
+#ifndef ARGPARSE_ARGUMENT_TABLE_HPP
+#define ARGPARSE_ARGUMENT_TABLE_HPP
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "argparse_memo.hpp"
+#include "argparse_string_pool.hpp"
+#include "argparse_suggestion.hpp"
+#include "argparse_value.hpp"
+
+namespace argparse {
+
+    class Argument;
+
+    enum class Action : uint8_t {
+        STORE,
+        STORE_TRUE,
+        STORE_FALSE,
+        HELP,
+        VERSION
+    };
+
+    enum class ShowIn : uint8_t {
+        USAGE_AND_HELP,
+        HELP_ONLY
+    };
+
+    //Argument metadata used while parsing, packed so the parse loop streams through it
+    struct ArgumentHot {
+        enum Flags : uint8_t {
+            REQUIRED    = 1 << 0,
+            DEFAULT_SET = 1 << 1,
+            POSITIONAL  = 1 << 2,
+            HAS_CHOICES = 1 << 3,
+            CHUNKED     = 1 << 4, //Values are passed to a callback in chunks (see Argument::chunked())
+            MEMOIZED    = 1 << 5, //Conversions are remembered (see Argument::memoize())
+        };
+
+        Action action = Action::STORE;
+        char nargs = '1';
+        uint8_t flags = 0;
+        char delimiter = '\0'; //Separator of the fields of each value ('\0' if values are not split)
+
+        bool has(Flags flag) const { return flags & flag; }
+        void set(Flags flag, bool value) { flags = value ? (flags | flag) : (flags & ~flag); }
+    };
+
+    //Argument metadata used only for help, error messages and set-up
+    struct ArgumentCold {
+        //Interned in the table's StringPool
+        const std::string* long_opt = nullptr;
+        const std::string* short_opt = nullptr;
+        const std::string* name = nullptr;
+        const std::string* metavar = nullptr;
+        const std::string* group_name = nullptr;
+
+        HelpText help;
+        std::vector<std::string> choices;
+        SuggestionIndex choice_index; //Index of choices for suggestions
+        std::vector<std::string> default_value;
+        ShowIn show_in = ShowIn::USAGE_AND_HELP;
+
+        //Passes the values accumulated in the destination to the chunk callback, if a full
+        //chunk has accumulated (or any values, if final is true)
+        std::function<void(void* dest, bool final)> flush_chunk;
+
+        //Remembered conversions of the argument's values (null unless MEMOIZED)
+        std::unique_ptr<ConversionMemoBase> memo;
+
+        //Next argument bound to the same destination; the arguments sharing a destination
+        //form a ring (of one, if the destination is not shared). Only up to date once the
+        //table's destinations are linked (see ArgumentTable::link_destinations_if_needed())
+        ArgumentId next_same_dest = NO_ARGUMENT_ID;
+
+        //Contribution of the destination's value to the configuration fingerprint (if value_hash_valid).
+        //Kept out of ArgumentHot::flags, which are part of the parser's definition (see ArgumentParser::fingerprint())
+        uint64_t value_hash = 0;
+        bool value_hash_valid = false;
+        bool in_config_fingerprint = true;
+    };
+
+    //A relationship between arguments, checked after parsing (see ArgumentParser::mutually_exclusive())
+    struct ArgumentConstraint {
+        enum class Kind : uint8_t {
+            MUTUALLY_EXCLUSIVE, //At most one of args may be specified
+            REQUIRES,           //If arg is specified all of args must be
+            AT_LEAST_ONE        //At least one of args must be specified
+        };
+
+        Kind kind = Kind::MUTUALLY_EXCLUSIVE;
+        ArgumentId arg = NO_ARGUMENT_ID; //The requiring argument (REQUIRES only)
+        std::vector<ArgumentId> args; //The constrained arguments
+        const std::string* group = nullptr; //If non-null, the arguments of this group are constrained instead of args
+    };
+
+    /*
+     * Parser-owned storage of arguments
+     *
+     * Each argument is assigned a dense ArgumentId when it is registered, which
+     * indexes two tables: the hot table holds the few fields consulted while
+     * parsing, and the cold table the strings used for help and error messages.
+     * The Argument objects themselves (which bind the destination) are allocated
+     * contiguously in blocks owned by the table, and are destroyed with it.
+     *
+     * The table also owns the StringPool used to intern the arguments' names.
+     */
+    class ArgumentTable {
+        public:
+            ArgumentTable() = default;
+            ArgumentTable(const ArgumentTable&) = delete;
+            ArgumentTable& operator=(const ArgumentTable&) = delete;
+            ~ArgumentTable();
+
+            //Constructs an argument (of type ArgType) in the table's storage.
+            //ArgType's constructor is expected to register itself with add()
+            template<typename ArgType, typename... Args>
+            ArgType& emplace(Args&&... args);
+
+            //Registers arg, returning its newly assigned ID
+            ArgumentId add(Argument* arg);
+
+            //Links the arguments sharing each destination into rings (see ArgumentCold::next_same_dest),
+            //if any were registered since they were last linked. Done in one pass when needed, rather
+            //than as each argument is registered
+            void link_destinations_if_needed() { if (!destinations_linked_) link_destinations(); }
+
+            //Returns the argument with the specified ID
+            Argument& argument(ArgumentId id) const;
+
+            //Returns the parse-time metadata of the argument with the specified ID
+            ArgumentHot& hot(ArgumentId id) { return hot_[id]; }
+            const ArgumentHot& hot(ArgumentId id) const { return hot_[id]; }
+
+            //Returns the help-time metadata of the argument with the specified ID
+            ArgumentCold& cold(ArgumentId id) { return cold_[id]; }
+            const ArgumentCold& cold(ArgumentId id) const { return cold_[id]; }
+
+            //Returns the parse-time metadata of all arguments (indexed by ArgumentId)
+            const std::vector<ArgumentHot>& hot_table() const { return hot_; }
+
+            //Returns the number of registered arguments
+            size_t size() const;
+
+            //Reserves space for num_args additional arguments
+            void reserve(size_t num_args);
+
+            //Returns the pool used to intern argument strings
+            StringPool& strings();
+
+            //Records a constraint between arguments (whose arguments have been checked by the parser)
+            void add_constraint(ArgumentConstraint constraint);
+
+            //Returns all recorded constraints
+            const std::vector<ArgumentConstraint>& constraints() const { return constraints_; }
+
+            //Prevents any further arguments or constraints being added (see ArgumentParser::freeze())
+            void freeze() { frozen_ = true; }
+
+            //Returns true if the table has been frozen
+            bool frozen() const { return frozen_; }
+
+            //Throws ArgParseError if the table has been frozen
+            void check_not_frozen() const;
+        private:
+            //Returns uninitialized storage of the specified size from the current block
+            void* allocate(size_t size);
+
+            //Removes the most recently registered argument (which failed to construct)
+            void remove_last();
+
+            //Links the arguments sharing each destination (see link_destinations_if_needed())
+            void link_destinations();
+        private:
+            StringPool strings_;
+            std::vector<Argument*> arguments_; //Indexed by ArgumentId
+            std::vector<ArgumentHot> hot_; //Indexed by ArgumentId
+            std::vector<ArgumentCold> cold_; //Indexed by ArgumentId
+            std::vector<ArgumentConstraint> constraints_;
+            bool destinations_linked_ = true;
+            bool frozen_ = false;
+
+            std::vector<std::unique_ptr<char[]>> blocks_; //Storage for Argument objects
+            size_t block_size_ = 0;
+            size_t block_used_ = 0;
+    };
+
+    template<typename ArgType, typename... Args>
+    ArgType& ArgumentTable::emplace(Args&&... args) {
+        void* storage = allocate(sizeof(ArgType));
+
+        size_t num_args = arguments_.size();
+        try {
+            return *new (storage) ArgType(std::forward<Args>(args)...);
+        } catch (...) {
+            //Forget the partially constructed argument (its storage is not re-used)
+            if (arguments_.size() > num_args) {
+                remove_last();
+            }
+            throw;
+        }
+    }
+
+} //namespace
+#endif
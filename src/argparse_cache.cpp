@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "argparse_cache.hpp"
+
+namespace argparse {
+
+    /*
+     * Fnv1aHash
+     */
+    void Fnv1aHash::add(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash_ ^= bytes[i];
+            hash_ *= 1099511628211ULL;
+        }
+    }
+
+    void Fnv1aHash::add(const std::string& str) {
+        add_value<uint64_t>(str.size());
+        add(str.data(), str.size());
+    }
+
+    uint64_t Fnv1aHash::value() const { return hash_; }
+
+    /*
+     * MappedFile
+     */
+#ifndef _WIN32
+    MappedFile::MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+
+        struct stat file_stat;
+        if (::fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+            void* mapping = ::mmap(nullptr, size_t(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                data_ = static_cast<const char*>(mapping);
+                size_ = size_t(file_stat.st_size);
+            }
+        }
+        ::close(fd); //The mapping remains valid
+    }
+
+    MappedFile::~MappedFile() {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+    }
+#else
+    MappedFile::MappedFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return;
+
+        std::stringstream ss;
+        ss << file.rdbuf();
+        contents_ = ss.str();
+        if (!contents_.empty()) {
+            data_ = contents_.data();
+            size_ = contents_.size();
+        }
+    }
+
+    MappedFile::~MappedFile() = default;
+#endif
+
+    bool MappedFile::valid() const { return data_ != nullptr; }
+    const char* MappedFile::data() const { return data_; }
+    size_t MappedFile::size() const { return size_; }
+
+    /*
+     * Utilities
+     */
+    bool write_file_atomic(const std::string& path, const std::string& data) {
+        //Write to a temporary and rename over the target, so readers never see a partial file
+        std::stringstream tmp_path;
+        tmp_path << path << ".tmp";
+#ifndef _WIN32
+        tmp_path << "." << ::getpid();
+#endif
+
+        {
+            std::ofstream file(tmp_path.str(), std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+            file.write(data.data(), std::streamsize(data.size()));
+            if (!file) {
+                std::remove(tmp_path.str().c_str());
+                return false;
+            }
+        }
+
+#ifdef _WIN32
+        std::remove(path.c_str()); //rename() does not replace existing files
+#endif
+        if (std::rename(tmp_path.str().c_str(), path.c_str()) != 0) {
+            std::remove(tmp_path.str().c_str());
+            return false;
+        }
+        return true;
+    }
+
+} //namespace
@@ -0,0 +1,133 @@
+#ifndef ARGPARSE_CACHE_HPP
+#define ARGPARSE_CACHE_HPP
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace argparse {
+
+    //Incremental 64-bit FNV-1a hash
+    class Fnv1aHash {
+        public:
+            //Adds size bytes at data to the hash
+            void add(const void* data, size_t size);
+
+            //Adds a (length prefixed) string to the hash
+            void add(const std::string& str);
+
+            //Adds a value's bytes to the hash
+            template<typename T>
+            void add_value(T value) {
+                static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only arithmetic/enum values can be hashed directly");
+                add(&value, sizeof(value));
+            }
+
+            //Returns the hash of everything added so far
+            uint64_t value() const;
+        private:
+            uint64_t hash_ = 14695981039346656037ULL;
+    };
+
+    /*
+     * A read-only view of a file's contents
+     *
+     * The file is memory mapped (or read into memory on platforms without mmap).
+     * valid() is false if the file could not be opened.
+     */
+    class MappedFile {
+        public:
+            explicit MappedFile(const std::string& path);
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+            ~MappedFile();
+
+            bool valid() const;
+            const char* data() const;
+            size_t size() const;
+        private:
+            const char* data_ = nullptr;
+            size_t size_ = 0;
+#ifdef _WIN32
+            std::string contents_;
+#endif
+    };
+
+    //Writes data to path, replacing any existing file atomically.
+    //Returns false if the file could not be written
+    bool write_file_atomic(const std::string& path, const std::string& data);
+
+    /*
+     * Binary serialization of destination values for the parse cache
+     *
+     * Only arithmetic and enum types, std::string, and std::vectors of those
+     * are supported (supported is false otherwise). Values are written in the
+     * host's byte order, since cache files are not shared between machines.
+     */
+    template<typename T, typename Enable=void>
+    struct ValueSerializer {
+        static constexpr bool supported = false;
+    };
+
+    template<typename T>
+    struct ValueSerializer<T,typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type> {
+        static constexpr bool supported = true;
+
+        static void write(const T& value, std::string& out) {
+            out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        static bool read(const char*& data, const char* end, T& value) {
+            if (size_t(end - data) < sizeof(value)) return false;
+            std::memcpy(&value, data, sizeof(value));
+            data += sizeof(value);
+            return true;
+        }
+    };
+
+    template<>
+    struct ValueSerializer<std::string> {
+        static constexpr bool supported = true;
+
+        static void write(const std::string& value, std::string& out) {
+            ValueSerializer<uint64_t>::write(value.size(), out);
+            out += value;
+        }
+
+        static bool read(const char*& data, const char* end, std::string& value) {
+            uint64_t size = 0;
+            if (!ValueSerializer<uint64_t>::read(data, end, size)) return false;
+            if (uint64_t(end - data) < size) return false;
+            value.assign(data, size);
+            data += size;
+            return true;
+        }
+    };
+
+    template<typename T>
+    struct ValueSerializer<std::vector<T>,typename std::enable_if<ValueSerializer<T>::supported>::type> {
+        static constexpr bool supported = true;
+
+        static void write(const std::vector<T>& values, std::string& out) {
+            ValueSerializer<uint64_t>::write(values.size(), out);
+            for (const T& value : values) {
+                ValueSerializer<T>::write(value, out);
+            }
+        }
+
+        static bool read(const char*& data, const char* end, std::vector<T>& values) {
+            uint64_t size = 0;
+            if (!ValueSerializer<uint64_t>::read(data, end, size)) return false;
+            values.clear();
+            for (uint64_t i = 0; i < size; ++i) {
+                T value = T();
+                if (!ValueSerializer<T>::read(data, end, value)) return false;
+                values.push_back(value);
+            }
+            return true;
+        }
+    };
+
+} //namespace
+#endif
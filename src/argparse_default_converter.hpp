@@ -1,6 +1,12 @@
 #ifndef ARGPARSE_DEFAULT_CONVERTER_HPP
 #define ARGPARSE_DEFAULT_CONVERTER_HPP
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <sstream>
+#include <type_traits>
 #include <vector>
 #include <typeinfo>
 #include "argparse_error.hpp"
@@ -32,58 +38,167 @@ template<typename T>
 typename std::enable_if<!std::is_floating_point<T>::value && !std::is_integral<T>::value, std::string>::type
 arg_type() { return ""; } //Empty
 
+/*
+ * Parse the NUL terminated str as a number, accepting the same syntax as stream
+ * extraction (optional leading whitespace, then the number, with nothing following).
+ * Returns false if str is not a valid number, or is out of range.
+ */
+//Signed Integer
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, bool>::type
+parse_number(const char* str, T& val) {
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(str, &end, 10);
+    if (end == str || *end != '\0' || errno == ERANGE
+        || parsed < static_cast<long long>(std::numeric_limits<T>::min())
+        || parsed > static_cast<long long>(std::numeric_limits<T>::max())) {
+        return false;
+    }
+    val = T(parsed);
+    return true;
+}
+
+//Unsigned Integer
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, bool>::type
+parse_number(const char* str, T& val) {
+    const char* first = str;
+    while (std::isspace(static_cast<unsigned char>(*first))) ++first;
+    if (*first == '-') return false; //strtoull() would wrap negative values
+
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(str, &end, 10);
+    if (end == str || *end != '\0' || errno == ERANGE
+        || parsed > static_cast<unsigned long long>(std::numeric_limits<T>::max())) {
+        return false;
+    }
+    val = T(parsed);
+    return true;
+}
+
+//Float
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+parse_number(const char* str, T& val) {
+    //Unlike stream extraction strtold() also accepts 'inf', 'nan' and hexadecimal values
+    for (const char* c = str; *c != '\0'; ++c) {
+        if (std::isalpha(static_cast<unsigned char>(*c)) && *c != 'e' && *c != 'E') return false;
+    }
+
+    char* end = nullptr;
+    long double parsed = std::strtold(str, &end);
+    if (end == str || *end != '\0'
+        || parsed < -static_cast<long double>(std::numeric_limits<T>::max())
+        || parsed > static_cast<long double>(std::numeric_limits<T>::max())) {
+        return false;
+    }
+    val = T(parsed);
+    return true;
+}
+
 /*
  * Default Conversions to/from strings
  */
 template<typename T>
 class DefaultConverter {
     public:
-        ConvertedValue<T> from_str(std::string str) {
-            std::stringstream ss(str);
-
-            T val = T();
-            ss >> val;
+        ConvertedValue<T> from_str(std::string str);
 
-            bool eof = ss.eof();
-            bool fail = ss.fail();
-            bool converted_ok = eof && !fail;
+        //Converts the characters [begin, end) (e.g. a field of a delimited list) without
+        //constructing a string. Only numeric types (excluding characters) are supported
+        template<typename U=T>
+        typename std::enable_if<(std::is_integral<U>::value && sizeof(U) > 1) || std::is_floating_point<U>::value, ConvertedValue<T>>::type
+        from_str(const char* begin, const char* end) {
+            //parse_number() requires a NUL terminated string, so copy the (short) value to the stack
+            char buf[64];
+            size_t len = size_t(end - begin);
+            if (len >= sizeof(buf)) {
+                return from_str(std::string(begin, end));
+            }
+            std::memcpy(buf, begin, len);
+            buf[len] = '\0';
 
             ConvertedValue<T> converted_value;
-            if (!converted_ok) {
-                std::stringstream msg;
-                msg << "Invalid conversion from '" << str << "'";
-                std::string arg_type_str = arg_type<T>();
-                if (!arg_type_str.empty()) {
-                    msg << " to " << arg_type_str;
-                }
-                converted_value.set_error(msg.str());
+            T val = T();
+            if (!parse_number(buf, val)) {
+                converted_value.set_error(conversion_error(std::string(begin, end)));
             } else {
                 converted_value.set_value(val);
-
             }
-
             return converted_value;
         }
 
-        ConvertedValue<std::string> to_str(T val) {
-            std::stringstream ss;
-            ss << val;
-
-            bool converted_ok = ss.eof() && !ss.fail();
+        ConvertedValue<std::string> to_str(T val);
 
-            ConvertedValue<std::string> converted_value;
-            if (!converted_ok) {
-                std::stringstream msg;
-                msg << "Invalid conversion from '" << val << "' to string";
-                converted_value.set_error(msg.str());
-            } else {
-                converted_value.set_value(ss.str());
-            }
-            return converted_value;
-        }
-        std::vector<std::string> default_choices() { return {}; }
+        std::vector<std::string> default_choices();
+    private:
+        static std::string conversion_error(const std::string& str);
 };
 
+//The stream based conversions are defined out of the class (so they are not implicitly inline),
+//allowing them to be instantiated once in the library for common types (see below)
+template<typename T>
+ConvertedValue<T> DefaultConverter<T>::from_str(std::string str) {
+    std::stringstream ss(str);
+
+    T val = T();
+    ss >> val;
+
+    //Extracting a character does not read on to the end of the stream, so also check nothing remains
+    bool eof = ss.eof() || ss.peek() == std::char_traits<char>::eof();
+    bool fail = ss.fail();
+    bool converted_ok = eof && !fail;
+
+    ConvertedValue<T> converted_value;
+    if (!converted_ok) {
+        converted_value.set_error(conversion_error(str));
+    } else {
+        converted_value.set_value(val);
+
+    }
+
+    return converted_value;
+}
+
+template<typename T>
+ConvertedValue<std::string> DefaultConverter<T>::to_str(T val) {
+    std::stringstream ss;
+    if (std::is_floating_point<T>::value) {
+        //Enough digits to convert back to the same value
+        ss.precision(std::numeric_limits<T>::max_digits10);
+    }
+    ss << val;
+
+    //Note that eof() is not set when writing, so only check for failure
+    bool converted_ok = !ss.fail();
+
+    ConvertedValue<std::string> converted_value;
+    if (!converted_ok) {
+        std::stringstream msg;
+        msg << "Invalid conversion from '" << val << "' to string";
+        converted_value.set_error(msg.str());
+    } else {
+        converted_value.set_value(ss.str());
+    }
+    return converted_value;
+}
+
+template<typename T>
+std::vector<std::string> DefaultConverter<T>::default_choices() { return {}; }
+
+template<typename T>
+std::string DefaultConverter<T>::conversion_error(const std::string& str) {
+    std::stringstream msg;
+    msg << "Invalid conversion from '" << str << "'";
+    std::string arg_type_str = arg_type<T>();
+    if (!arg_type_str.empty()) {
+        msg << " to " << arg_type_str;
+    }
+    return msg.str();
+}
+
 //DefaultConverter specializations for bool
 // By default std::stringstream doesn't accept "true" or "false"
 // as boolean values.
@@ -170,6 +285,30 @@ class DefaultConverter<char*> {
         }
         std::vector<std::string> default_choices() { return {}; }
 };
+//Instantiated in the library (see src/instantiations)
+#define ARGPARSE_NUMERIC_TYPES(X) \
+    X(short) \
+    X(unsigned short) \
+    X(int) \
+    X(unsigned int) \
+    X(long) \
+    X(unsigned long) \
+    X(long long) \
+    X(unsigned long long) \
+    X(float) \
+    X(double)
+
+//Converted as single characters (see the stream based from_str())
+#define ARGPARSE_CHARACTER_TYPES(X) \
+    X(char) \
+    X(signed char) \
+    X(unsigned char)
+
+#define ARGPARSE_EXTERN_DEFAULT_CONVERTER(T) extern template class DefaultConverter<T>;
+ARGPARSE_NUMERIC_TYPES(ARGPARSE_EXTERN_DEFAULT_CONVERTER)
+ARGPARSE_CHARACTER_TYPES(ARGPARSE_EXTERN_DEFAULT_CONVERTER)
+#undef ARGPARSE_EXTERN_DEFAULT_CONVERTER
+
 } //namespace
 
 #endif
@@ -34,7 +34,7 @@ namespace argparse {
 
         int num_unshown_options = 0;
         for (const auto& group : parser_->argument_groups()) {
-            auto args = group.arguments();
+            const auto& args = group.arguments();
             for(const auto& arg : args) {
 
                 if(arg->show_in() != ShowIn::USAGE_AND_HELP) {
@@ -64,6 +64,11 @@ namespace argparse {
             ss << " [OTHER_OPTIONS ...]";
         }
 
+        auto subcommands = parser_->subcommands();
+        if (!subcommands.empty()) {
+            ss << " {" << join(subcommands, ", ") << "} ...";
+        }
+
         size_t prefix_len = USAGE_PREFIX.size();
 
         std::stringstream wrapped_ss;
@@ -99,7 +104,7 @@ namespace argparse {
         std::stringstream ss;
 
         for (const auto& group : parser_->argument_groups()) {
-            auto args = group.arguments();
+            const auto& args = group.arguments();
             if (args.size() > 0) {
                 ss << "\n";
                 ss << group.name() << ":" << "\n";
@@ -166,6 +171,32 @@ namespace argparse {
             }
         }
 
+        auto subcommands = parser_->subcommands();
+        if (!subcommands.empty()) {
+            //Only the names and help are listed, so the sub-command parsers are not constructed
+            ss << "\n";
+            ss << "subcommands:" << "\n";
+            for (const auto& name : subcommands) {
+                std::stringstream cmd_ss;
+                cmd_ss << INDENT << name;
+
+                size_t pos = cmd_ss.str().size();
+                if (pos + OPTION_HELP_SLACK > option_name_width_) {
+                    cmd_ss << "\n";
+                    pos = 0;
+                }
+
+                for (auto& line : wrap_width(parser_->subcommand_help(name), total_width_ - option_name_width_)) {
+                    assert(pos <= option_name_width_);
+                    cmd_ss << std::string(option_name_width_ - pos, ' ');
+                    cmd_ss << line;
+                    pos = 0;
+                }
+                cmd_ss << "\n";
+                ss << cmd_ss.str();
+            }
+        }
+
         return ss.str();
     }
 
@@ -193,6 +224,10 @@ namespace argparse {
         auto long_opt = argument.long_option();
         if(argument.nargs() != '0' && !argument.positional()) {
             long_opt += + " " + determine_metavar(argument);
+        } else if (argument.positional() && argument.nargs() == '+') {
+            long_opt += " [" + long_opt + " ...]";
+        } else if (argument.positional() && argument.nargs() == '*') {
+            long_opt += " ..."; //Optional, so already bracketed in the usage
         }
         return long_opt;
     }
@@ -227,6 +262,9 @@ namespace argparse {
             choices_ss << "}";
             base_metavar = choices_ss.str();
         }
+        if (arg.delimiter()) {
+            base_metavar += "[" + std::string(1, arg.delimiter()) + base_metavar + "...]";
+        }
 
         std::string metavar;
         if (arg.nargs() == '0' || arg.positional()) {
@@ -0,0 +1,97 @@
+#ifndef ARGPARSE_MEMO_HPP
+#define ARGPARSE_MEMO_HPP
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "argparse_value.hpp"
+
+namespace argparse {
+
+    //Counts of look-ups in a ConversionMemo
+    struct MemoStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t size = 0; //Number of values currently remembered
+    };
+
+    //Type independent interface of a ConversionMemo
+    class ConversionMemoBase {
+        public:
+            virtual ~ConversionMemoBase() = default;
+
+            virtual MemoStats stats() const = 0;
+    };
+
+    /*
+     * Remembers the results (values or errors) of converting raw tokens, so a repeated
+     * token is not converted again (see Argument::memoize())
+     *
+     * At most max_entries results are held, evicting the least recently used.
+     * All operations are guarded by a mutex, so a memo may be used by the concurrent
+     * parses of a frozen parser (see ArgumentParser::freeze()).
+     */
+    template<typename T>
+    class ConversionMemo : public ConversionMemoBase {
+        public:
+            explicit ConversionMemo(size_t max_entries)
+                : max_entries_(max_entries) {}
+
+            //Sets converted_value to the remembered conversion of token, returning false if there is none
+            bool find(const std::string& token, ConvertedValue<T>& converted_value) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto iter = index_.find(token);
+                if (iter == index_.end()) {
+                    ++misses_;
+                    return false;
+                }
+                entries_.splice(entries_.begin(), entries_, iter->second); //Now most recently used
+                converted_value = iter->second->second;
+                ++hits_;
+                return true;
+            }
+
+            //Remembers the conversion of token
+            void insert(const std::string& token, const ConvertedValue<T>& converted_value) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto iter = index_.find(token);
+                if (iter != index_.end()) {
+                    //Converted concurrently by another parse
+                    iter->second->second = converted_value;
+                    entries_.splice(entries_.begin(), entries_, iter->second);
+                    return;
+                }
+
+                if (entries_.size() >= max_entries_) {
+                    if (entries_.empty()) return;
+                    index_.erase(entries_.back().first);
+                    entries_.pop_back();
+                }
+                entries_.emplace_front(token, converted_value);
+                index_.emplace(token, entries_.begin());
+            }
+
+            MemoStats stats() const override {
+                std::lock_guard<std::mutex> lock(mutex_);
+                MemoStats memo_stats;
+                memo_stats.hits = hits_;
+                memo_stats.misses = misses_;
+                memo_stats.size = entries_.size();
+                return memo_stats;
+            }
+        private:
+            typedef std::list<std::pair<std::string,ConvertedValue<T>>> Entries;
+
+            size_t max_entries_;
+            Entries entries_; //Most recently used first
+            std::unordered_map<std::string,typename Entries::iterator> index_;
+            size_t hits_ = 0;
+            size_t misses_ = 0;
+            mutable std::mutex mutex_;
+    };
+
+} //namespace
+#endif
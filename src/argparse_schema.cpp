@@ -0,0 +1,680 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <sstream>
+
+#include "argparse_util.hpp"
+#include "argparse_schema.hpp"
+#include "argparse_default_converter.hpp"
+#include "argparse_error.hpp"
+#include "argparse_token_source.hpp"
+
+namespace argparse {
+
+    static const char* action_str(Action action);
+    static Action str_action(const std::string& str);
+    static void write_json_string(const std::string& str, std::string& out);
+    static void write_json_strings(const std::vector<std::string>& strs, std::string& out);
+    static void append_utf8(unsigned code_point, std::string& out);
+
+    /*
+     * Reads the JSON subset written by ParserSchema::to_json() (objects, arrays, strings,
+     * integers and booleans), directly into the schema rather than via a document tree
+     */
+    class ParserSchema::JsonReader {
+        public:
+            explicit JsonReader(const std::string& json)
+                : pos_(json.data())
+                , end_(json.data() + json.size())
+                , begin_(json.data()) {}
+
+            //Starts reading an object
+            void begin_object() { expect('{'); }
+
+            //Reads the key of the next member of the current object into key, returning false (and
+            //consuming the closing brace) if there are no more. first must be true on the first call
+            bool next_member(bool& first, std::string& key) {
+                if (consume('}')) return false;
+                if (!first) expect(',');
+                first = false;
+                key = read_string();
+                expect(':');
+                return true;
+            }
+
+            //Starts reading an array
+            void begin_array() { expect('['); }
+
+            //Returns false (consuming the closing bracket) if there are no more elements in the current array.
+            //first must be true on the first call
+            bool next_element(bool& first) {
+                if (consume(']')) return false;
+                if (!first) expect(',');
+                first = false;
+                return true;
+            }
+
+            std::string read_string() {
+                expect('"');
+                std::string str;
+                while (true) {
+                    if (pos_ == end_) error("unterminated string");
+                    char c = *pos_++;
+                    if (c == '"') break;
+                    if (c != '\\') {
+                        str += c;
+                        continue;
+                    }
+
+                    if (pos_ == end_) error("unterminated string");
+                    char escaped = *pos_++;
+                    switch (escaped) {
+                        case '"': str += '"'; break;
+                        case '\\': str += '\\'; break;
+                        case '/': str += '/'; break;
+                        case 'b': str += '\b'; break;
+                        case 'f': str += '\f'; break;
+                        case 'n': str += '\n'; break;
+                        case 'r': str += '\r'; break;
+                        case 't': str += '\t'; break;
+                        case 'u': {
+                            unsigned code_point = read_hex4();
+                            if (code_point >= 0xD800 && code_point < 0xDC00) {
+                                //High surrogate, combine with the following low surrogate
+                                if (end_ - pos_ < 2 || pos_[0] != '\\' || pos_[1] != 'u') error("unpaired surrogate");
+                                pos_ += 2;
+                                unsigned low = read_hex4();
+                                if (low < 0xDC00 || low >= 0xE000) error("unpaired surrogate");
+                                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                            }
+                            append_utf8(code_point, str);
+                            break;
+                        }
+                        default:
+                            error("invalid escape");
+                    }
+                }
+                return str;
+            }
+
+            std::vector<std::string> read_strings() {
+                std::vector<std::string> strs;
+                begin_array();
+                bool first = true;
+                while (next_element(first)) {
+                    strs.push_back(read_string());
+                }
+                return strs;
+            }
+
+            bool read_bool() {
+                skip_whitespace();
+                if (consume_literal("true")) return true;
+                if (consume_literal("false")) return false;
+                error("expected boolean");
+                return false;
+            }
+
+            long long read_integer() {
+                skip_whitespace();
+                const char* start = pos_;
+                if (pos_ != end_ && *pos_ == '-') ++pos_;
+                while (pos_ != end_ && *pos_ >= '0' && *pos_ <= '9') ++pos_;
+                if (pos_ == start || (pos_ - start == 1 && *start == '-')) error("expected integer");
+
+                long long val = 0;
+                if (!parse_number(std::string(start, pos_).c_str(), val)) error("integer out of range");
+                return val;
+            }
+
+            //Skips a value of any type (e.g. of a member added by a later version)
+            void skip_value() {
+                skip_whitespace();
+                if (pos_ == end_) error("expected value");
+
+                char c = *pos_;
+                if (c == '"') {
+                    read_string();
+                } else if (c == '{') {
+                    begin_object();
+                    bool first = true;
+                    std::string key;
+                    while (next_member(first, key)) {
+                        skip_value();
+                    }
+                } else if (c == '[') {
+                    begin_array();
+                    bool first = true;
+                    while (next_element(first)) {
+                        skip_value();
+                    }
+                } else if (consume_literal("true") || consume_literal("false") || consume_literal("null")) {
+                    //Literal
+                } else {
+                    //Number
+                    const char* start = pos_;
+                    while (pos_ != end_ && (std::isdigit(static_cast<unsigned char>(*pos_))
+                                            || *pos_ == '-' || *pos_ == '+' || *pos_ == '.' || *pos_ == 'e' || *pos_ == 'E')) {
+                        ++pos_;
+                    }
+                    if (pos_ == start) error("expected value");
+                }
+            }
+
+            //Checks nothing but whitespace remains
+            void finish() {
+                skip_whitespace();
+                if (pos_ != end_) error("unexpected trailing characters");
+            }
+
+            [[noreturn]] void error(const char* what) const {
+                std::stringstream msg;
+                msg << "Invalid parser schema: " << what << " at offset " << (pos_ - begin_);
+                throw ArgParseError(msg.str());
+            }
+        private:
+            void skip_whitespace() {
+                while (pos_ != end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r')) ++pos_;
+            }
+
+            bool consume(char c) {
+                skip_whitespace();
+                if (pos_ != end_ && *pos_ == c) {
+                    ++pos_;
+                    return true;
+                }
+                return false;
+            }
+
+            void expect(char c) {
+                if (!consume(c)) {
+                    std::string what = std::string("expected '") + c + "'";
+                    error(what.c_str());
+                }
+            }
+
+            bool consume_literal(const char* literal) {
+                size_t len = std::char_traits<char>::length(literal);
+                if (size_t(end_ - pos_) >= len && std::equal(literal, literal + len, pos_)) {
+                    pos_ += len;
+                    return true;
+                }
+                return false;
+            }
+
+            unsigned read_hex4() {
+                if (end_ - pos_ < 4) error("invalid unicode escape");
+                unsigned code_point = 0;
+                for (size_t i = 0; i < 4; ++i) {
+                    char c = *pos_++;
+                    code_point <<= 4;
+                    if (c >= '0' && c <= '9') code_point |= unsigned(c - '0');
+                    else if (c >= 'a' && c <= 'f') code_point |= unsigned(c - 'a' + 10);
+                    else if (c >= 'A' && c <= 'F') code_point |= unsigned(c - 'A' + 10);
+                    else error("invalid unicode escape");
+                }
+                return code_point;
+            }
+        private:
+            const char* pos_;
+            const char* end_;
+            const char* begin_;
+    };
+
+    //The schema's argument definitions, as used to resolve and check command-lines
+    class ParserSchema::SchemaArguments : public ArgumentMetadata {
+        public:
+            explicit SchemaArguments(const ParserSchema& schema)
+                : schema_(schema) {}
+
+            const std::vector<ArgumentHot>& hot_table() const override { return schema_.hot_table_; }
+
+            const std::string& argument_name(ArgumentId id) const override { return schema_.arguments_[id].name; }
+
+            const std::vector<std::string>& argument_choices(ArgumentId id) const override { return schema_.arguments_[id].choices; }
+
+            std::vector<std::string> suggest_choices(ArgumentId id, const std::string& value) const override {
+                return SuggestionIndex(schema_.arguments_[id].choices).suggest(value);
+            }
+
+            bool is_convertible_value(ArgumentId id, const std::string& value) const override {
+                try {
+                    schema_.check_type(schema_.arguments_[id], value);
+                } catch (const ArgParseConversionError&) {
+                    return false;
+                }
+                return true;
+            }
+
+            std::string field_error(ArgumentId id, const std::string& value) const override {
+                try {
+                    schema_.check_type(schema_.arguments_[id], value);
+                } catch (const ArgParseConversionError& e) {
+                    return e.what();
+                }
+                return std::string();
+            }
+
+            std::vector<std::string> suggest_options(const std::string& str, const OptionTable& /*options*/) const override {
+                return schema_.option_index_.suggest(str);
+            }
+
+            std::vector<std::string> subcommand_names() const override {
+                std::vector<std::string> names;
+                for (const Subcommand& subcommand : schema_.subcommands_) {
+                    names.push_back(subcommand.name);
+                }
+                return names;
+            }
+
+            bool subcommand_required() const override { return schema_.subcommand_required_; }
+        private:
+            const ParserSchema& schema_;
+    };
+
+    //Checks the type of each resolved value, recording which arguments were specified
+    class ParserSchema::SchemaTokenResolver : public TokenResolver {
+        public:
+            SchemaTokenResolver(const ParserSchema& schema, const SchemaArguments& args)
+                : TokenResolver(args, schema.options_)
+                , schema_(schema)
+                , specified_arguments_(schema.arguments_.size(), false) {}
+
+            const std::vector<bool>& specified_arguments() const { return specified_arguments_; }
+        protected:
+            void on_option(ArgumentId id, const std::string& /*option_str*/) override {
+                specified_arguments_[id] = true;
+
+                //The parser stops to print the help or version
+                if (schema_.arguments_[id].action == Action::HELP) {
+                    throw ArgParseHelp();
+                } else if (schema_.arguments_[id].action == Action::VERSION) {
+                    throw ArgParseVersion();
+                }
+            }
+
+            void on_value(ArgumentId id, const std::string& value) override {
+                const ArgumentSchema& arg = schema_.arguments_[id];
+                try {
+                    schema_.check_type(arg, value);
+                } catch (const ArgParseConversionError& e) {
+                    throw ArgParseConversionError(std::string(e.what()) + " for " + arg.name);
+                }
+            }
+
+            void on_positional(ArgumentId id, const std::string& value) override {
+                const ArgumentSchema& arg = schema_.arguments_[id];
+                try {
+                    schema_.check_type(arg, value);
+                } catch (const ArgParseConversionError& e) {
+                    throw ArgParseConversionError(std::string(e.what()) + " for positional argument " + arg.long_opt);
+                }
+                specified_arguments_[id] = true;
+            }
+
+            void on_subcommand(int /*index*/, const std::string& /*name*/) override {}
+        private:
+            const ParserSchema& schema_;
+            std::vector<bool> specified_arguments_;
+    };
+
+    /*
+     * ParserSchema
+     */
+    ParserSchema::ParserSchema(std::string prog_str, std::string description_str, std::vector<ArgumentSchema> argument_schemas,
+                               std::vector<Subcommand> subcommand_schemas, bool is_subcommand_required)
+        : prog_(prog_str)
+        , description_(description_str)
+        , arguments_(std::move(argument_schemas))
+        , subcommands_(std::move(subcommand_schemas))
+        , subcommand_required_(is_subcommand_required) {
+        if (arguments_.size() >= NO_ARGUMENT_ID) {
+            throw ArgParseError("Too many arguments in parser schema");
+        }
+
+        std::vector<std::string> option_strs;
+        hot_table_.reserve(arguments_.size());
+        for (size_t id = 0; id < arguments_.size(); ++id) {
+            const ArgumentSchema& arg = arguments_[id];
+
+            ArgumentHot hot;
+            hot.action = arg.action;
+            hot.nargs = arg.nargs;
+            hot.delimiter = arg.delimiter;
+            hot.set(ArgumentHot::REQUIRED, arg.required);
+            hot.set(ArgumentHot::POSITIONAL, arg.positional);
+            hot.set(ArgumentHot::HAS_CHOICES, !arg.choices.empty());
+            hot_table_.push_back(hot);
+
+            options_.add(ArgumentId(id), arg.positional, arg.long_opt, arg.short_opt);
+            if (!arg.positional) {
+                for (const std::string* opt : {&arg.long_opt, &arg.short_opt}) {
+                    if (!opt->empty()) option_strs.push_back(*opt);
+                }
+            }
+        }
+        option_index_ = SuggestionIndex(option_strs);
+    }
+
+    ParserSchema ParserSchema::from_json(const std::string& json) {
+        JsonReader reader(json);
+        ParserSchema schema = read(reader);
+        reader.finish();
+        return schema;
+    }
+
+    std::string ParserSchema::to_json() const {
+        std::string out;
+        write(out);
+        return out;
+    }
+
+    void ParserSchema::validate(const std::vector<std::string>& args) const {
+        VectorTokenSource tokens(args);
+        try {
+            validate(tokens);
+        } catch (const ArgParseHelp&) {
+            //The parser stops to print the help, accepting the command-line
+        } catch (const ArgParseVersion&) {
+            //Likewise to print the version
+        }
+    }
+
+    const std::string& ParserSchema::prog() const { return prog_; }
+    const std::string& ParserSchema::description() const { return description_; }
+    const std::vector<ArgumentSchema>& ParserSchema::arguments() const { return arguments_; }
+    const std::vector<ParserSchema::Subcommand>& ParserSchema::subcommands() const { return subcommands_; }
+    bool ParserSchema::subcommand_required() const { return subcommand_required_; }
+
+    ParserSchema ParserSchema::read(JsonReader& reader) {
+        long long version = -1;
+        std::string prog_str;
+        std::string description_str;
+        std::vector<ArgumentSchema> argument_schemas;
+        std::vector<Subcommand> subcommand_schemas;
+        bool is_subcommand_required = false;
+
+        reader.begin_object();
+        bool first = true;
+        std::string key;
+        while (reader.next_member(first, key)) {
+            if (key == "version") {
+                version = reader.read_integer();
+                if (version != PARSER_SCHEMA_VERSION) {
+                    std::stringstream msg;
+                    msg << "Unsupported parser schema version " << version << " (expected " << PARSER_SCHEMA_VERSION << ")";
+                    throw ArgParseError(msg.str());
+                }
+            } else if (key == "prog") {
+                prog_str = reader.read_string();
+            } else if (key == "description") {
+                description_str = reader.read_string();
+            } else if (key == "subcommand_required") {
+                is_subcommand_required = reader.read_bool();
+            } else if (key == "arguments") {
+                reader.begin_array();
+                bool first_arg = true;
+                while (reader.next_element(first_arg)) {
+                    argument_schemas.push_back(read_argument(reader));
+                }
+            } else if (key == "subcommands") {
+                reader.begin_array();
+                bool first_subcommand = true;
+                while (reader.next_element(first_subcommand)) {
+                    Subcommand subcommand;
+                    reader.begin_object();
+                    bool first_member = true;
+                    std::string member;
+                    while (reader.next_member(first_member, member)) {
+                        if (member == "name") {
+                            subcommand.name = reader.read_string();
+                        } else if (member == "help") {
+                            subcommand.help = reader.read_string();
+                        } else if (member == "schema") {
+                            subcommand.schema = std::make_shared<ParserSchema>(read(reader));
+                        } else {
+                            reader.skip_value();
+                        }
+                    }
+                    if (!subcommand.schema) reader.error("sub-command without schema");
+                    subcommand_schemas.push_back(std::move(subcommand));
+                }
+            } else {
+                reader.skip_value();
+            }
+        }
+
+        if (version < 0) reader.error("missing version");
+
+        return ParserSchema(prog_str, description_str, std::move(argument_schemas), std::move(subcommand_schemas), is_subcommand_required);
+    }
+
+    ArgumentSchema ParserSchema::read_argument(JsonReader& reader) {
+        ArgumentSchema arg;
+
+        reader.begin_object();
+        bool first = true;
+        std::string key;
+        while (reader.next_member(first, key)) {
+            if (key == "name") {
+                arg.name = reader.read_string();
+            } else if (key == "long_opt") {
+                arg.long_opt = reader.read_string();
+            } else if (key == "short_opt") {
+                arg.short_opt = reader.read_string();
+            } else if (key == "group") {
+                arg.group = reader.read_string();
+            } else if (key == "help") {
+                arg.help = reader.read_string();
+            } else if (key == "metavar") {
+                arg.metavar = reader.read_string();
+            } else if (key == "type") {
+                arg.type = reader.read_string();
+            } else if (key == "action") {
+                arg.action = str_action(reader.read_string());
+            } else if (key == "nargs") {
+                std::string nargs_str = reader.read_string();
+                if (nargs_str.size() != 1) reader.error("invalid nargs");
+                arg.nargs = nargs_str[0];
+            } else if (key == "delimiter") {
+                std::string delimiter_str = reader.read_string();
+                if (delimiter_str.size() > 1) reader.error("invalid delimiter");
+                arg.delimiter = delimiter_str.empty() ? '\0' : delimiter_str[0];
+            } else if (key == "choices") {
+                arg.choices = reader.read_strings();
+            } else if (key == "default") {
+                arg.default_value = reader.read_strings();
+            } else if (key == "required") {
+                arg.required = reader.read_bool();
+            } else if (key == "positional") {
+                arg.positional = reader.read_bool();
+            } else {
+                reader.skip_value();
+            }
+        }
+        return arg;
+    }
+
+    void ParserSchema::write(std::string& out) const {
+        out += "{\"version\":";
+        out += std::to_string(PARSER_SCHEMA_VERSION);
+        out += ",\"prog\":";
+        write_json_string(prog_, out);
+        out += ",\"description\":";
+        write_json_string(description_, out);
+        out += ",\"subcommand_required\":";
+        out += subcommand_required_ ? "true" : "false";
+
+        out += ",\"arguments\":[";
+        for (size_t i = 0; i < arguments_.size(); ++i) {
+            const ArgumentSchema& arg = arguments_[i];
+            if (i != 0) out += ',';
+            out += "{\"name\":";
+            write_json_string(arg.name, out);
+            out += ",\"long_opt\":";
+            write_json_string(arg.long_opt, out);
+            out += ",\"short_opt\":";
+            write_json_string(arg.short_opt, out);
+            out += ",\"group\":";
+            write_json_string(arg.group, out);
+            out += ",\"help\":";
+            write_json_string(arg.help, out);
+            out += ",\"metavar\":";
+            write_json_string(arg.metavar, out);
+            out += ",\"type\":";
+            write_json_string(arg.type, out);
+            out += ",\"action\":";
+            write_json_string(action_str(arg.action), out);
+            out += ",\"nargs\":";
+            write_json_string(std::string(1, arg.nargs), out);
+            out += ",\"delimiter\":";
+            write_json_string(arg.delimiter ? std::string(1, arg.delimiter) : std::string(), out);
+            out += ",\"choices\":";
+            write_json_strings(arg.choices, out);
+            out += ",\"default\":";
+            write_json_strings(arg.default_value, out);
+            out += ",\"required\":";
+            out += arg.required ? "true" : "false";
+            out += ",\"positional\":";
+            out += arg.positional ? "true" : "false";
+            out += '}';
+        }
+        out += ']';
+
+        out += ",\"subcommands\":[";
+        for (size_t i = 0; i < subcommands_.size(); ++i) {
+            if (i != 0) out += ',';
+            out += "{\"name\":";
+            write_json_string(subcommands_[i].name, out);
+            out += ",\"help\":";
+            write_json_string(subcommands_[i].help, out);
+            out += ",\"schema\":";
+            subcommands_[i].schema->write(out);
+            out += '}';
+        }
+        out += "]}";
+    }
+
+    void ParserSchema::validate(TokenSource& tokens) const {
+        SchemaArguments args(*this);
+        SchemaTokenResolver resolver(*this, args);
+        int subcommand = resolver.resolve(tokens, nullptr);
+        check_required_arguments(args, resolver.specified_arguments(), subcommand >= 0);
+        if (subcommand >= 0) {
+            //Validates all remaining arguments
+            subcommands_[subcommand].schema->validate(tokens);
+        }
+    }
+
+    void ParserSchema::check_type(const ArgumentSchema& arg, const std::string& value) const {
+        if (arg.type.empty()) return;
+
+        auto check_field = [&](const std::string& field) {
+            std::string error;
+            if (arg.type == arg_type<long long>()) {
+                ConvertedValue<long long> converted_value = DefaultConverter<long long>().from_str(field);
+                if (!converted_value) error = converted_value.error();
+            } else if (arg.type == arg_type<unsigned long long>()) {
+                ConvertedValue<unsigned long long> converted_value = DefaultConverter<unsigned long long>().from_str(field);
+                if (!converted_value) error = converted_value.error();
+            } else if (arg.type == arg_type<double>()) {
+                ConvertedValue<double> converted_value = DefaultConverter<double>().from_str(field);
+                if (!converted_value) error = converted_value.error();
+            }
+            return error;
+        };
+
+        if (!arg.delimiter) {
+            std::string error = check_field(value);
+            if (!error.empty()) {
+                throw ArgParseConversionError(error);
+            }
+            return;
+        }
+
+        std::string field;
+        for_each_field(value, arg.delimiter, [&](const char* field_begin, const char* field_end, size_t index) {
+            field.assign(field_begin, field_end);
+            std::string error = check_field(field);
+            if (!error.empty()) {
+                std::stringstream msg;
+                msg << error << " (field " << index + 1 << ")";
+                throw ArgParseConversionError(msg.str());
+            }
+            return true;
+        });
+    }
+
+    /*
+     * Helpers
+     */
+    static const char* action_str(Action action) {
+        switch (action) {
+            case Action::STORE: return "store";
+            case Action::STORE_TRUE: return "store_true";
+            case Action::STORE_FALSE: return "store_false";
+            case Action::HELP: return "help";
+            case Action::VERSION: return "version";
+            default: throw ArgParseError("Unrecognized argparse action");
+        }
+    }
+
+    static Action str_action(const std::string& str) {
+        for (Action action : {Action::STORE, Action::STORE_TRUE, Action::STORE_FALSE, Action::HELP, Action::VERSION}) {
+            if (str == action_str(action)) {
+                return action;
+            }
+        }
+        throw ArgParseError("Invalid parser schema: unrecognized action '" + str + "'");
+    }
+
+    static void write_json_string(const std::string& str, std::string& out) {
+        out += '"';
+        for (char c : str) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", unsigned(c));
+                        out += escaped;
+                    } else {
+                        out += c; //UTF-8 is passed through
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    static void write_json_strings(const std::vector<std::string>& strs, std::string& out) {
+        out += '[';
+        for (size_t i = 0; i < strs.size(); ++i) {
+            if (i != 0) out += ',';
+            write_json_string(strs[i], out);
+        }
+        out += ']';
+    }
+
+    static void append_utf8(unsigned code_point, std::string& out) {
+        if (code_point < 0x80) {
+            out += char(code_point);
+        } else if (code_point < 0x800) {
+            out += char(0xC0 | (code_point >> 6));
+            out += char(0x80 | (code_point & 0x3F));
+        } else if (code_point < 0x10000) {
+            out += char(0xE0 | (code_point >> 12));
+            out += char(0x80 | ((code_point >> 6) & 0x3F));
+            out += char(0x80 | (code_point & 0x3F));
+        } else {
+            out += char(0xF0 | (code_point >> 18));
+            out += char(0x80 | ((code_point >> 12) & 0x3F));
+            out += char(0x80 | ((code_point >> 6) & 0x3F));
+            out += char(0x80 | (code_point & 0x3F));
+        }
+    }
+
+} //namespace
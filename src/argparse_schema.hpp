@@ -0,0 +1,101 @@
+#ifndef ARGPARSE_SCHEMA_HPP
+#define ARGPARSE_SCHEMA_HPP
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "argparse_argument_table.hpp"
+#include "argparse_suggestion.hpp"
+#include "argparse_token_resolver.hpp"
+#include "argparse_value.hpp"
+
+namespace argparse {
+
+    //Version of the schema format written by ParserSchema::to_json()
+    constexpr int PARSER_SCHEMA_VERSION = 1;
+
+    //The definition of a single argument within a ParserSchema
+    struct ArgumentSchema {
+        std::string name;
+        std::string long_opt;
+        std::string short_opt; //Empty if none
+        std::string group;
+        std::string help;
+        std::string metavar;
+        std::string type; //The value type (see arg_type()), or empty if only the converter can check values
+        Action action = Action::STORE;
+        char nargs = '1';
+        char delimiter = '\0'; //'\0' if values are not split
+        std::vector<std::string> choices;
+        std::vector<std::string> default_value;
+        bool required = false;
+        bool positional = false;
+    };
+
+    /*
+     * A parser's definition (see ArgumentParser::schema()), which can be saved as JSON
+     * and used to check command-lines without constructing the parser (or running the
+     * program which defines it)
+     */
+    class ParserSchema {
+        public:
+            struct Subcommand {
+                std::string name;
+                std::string help;
+                std::shared_ptr<const ParserSchema> schema;
+            };
+
+        public:
+            ParserSchema() = default;
+            ParserSchema(std::string prog, std::string description, std::vector<ArgumentSchema> arguments,
+                         std::vector<Subcommand> subcommands, bool subcommand_required);
+
+            //Reads a schema written by to_json().
+            //Throws ArgParseError if json is malformed, or of an unsupported version
+            static ParserSchema from_json(const std::string& json);
+
+            //Returns the schema as a (versioned) JSON object
+            std::string to_json() const;
+
+            //Checks args would be accepted by the parser, throwing ArgParseError (with the parser's
+            //message) if not. Values are checked against their choices and numeric type, but
+            //are not converted (so the range of narrow integer types, or the values of custom
+            //converters, are not checked)
+            void validate(const std::vector<std::string>& args) const;
+
+        public: //Accessors
+            const std::string& prog() const;
+            const std::string& description() const;
+            const std::vector<ArgumentSchema>& arguments() const;
+            const std::vector<Subcommand>& subcommands() const;
+            bool subcommand_required() const;
+
+        private:
+            class JsonReader;
+            class SchemaArguments;
+            class SchemaTokenResolver;
+
+            static ParserSchema read(JsonReader& reader);
+            static ArgumentSchema read_argument(JsonReader& reader);
+            void write(std::string& out) const;
+
+            void validate(TokenSource& tokens) const;
+
+            //Throws ArgParseConversionError if value (or any of its fields) is not of arg's type
+            void check_type(const ArgumentSchema& arg, const std::string& value) const;
+
+        private:
+            std::string prog_;
+            std::string description_;
+            std::vector<ArgumentSchema> arguments_;
+            std::vector<Subcommand> subcommands_;
+            bool subcommand_required_ = false;
+
+            //Built from arguments_
+            std::vector<ArgumentHot> hot_table_;
+            OptionTable options_;
+            SuggestionIndex option_index_;
+    };
+
+} //namespace
+#endif
@@ -0,0 +1,64 @@
+#ifndef ARGPARSE_STATS_HPP
+#define ARGPARSE_STATS_HPP
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace argparse {
+
+    //Function returning the number of heap allocations made so far by the program
+    //(e.g. from a counting replacement of operator new)
+    typedef std::function<size_t()> AllocationCounter;
+
+    /*
+     * Statistics collected during a parse (see ArgumentParser::collect_parse_stats())
+     */
+    struct ParseStats {
+        typedef std::chrono::nanoseconds Duration;
+
+        //Time spent in each phase of the parse
+        Duration table_construction{0};  //Building the option look-up table
+        Duration token_resolution{0};    //Reading and matching tokens to arguments (including lookahead and choice validation)
+        Duration lookahead{0};           //Checking candidate values following an option (including their conversion and choice validation)
+        Duration choice_validation{0};   //Checking values against the valid choices
+        Duration default_application{0}; //Setting destinations to their defaults
+        Duration conversion{0};          //Converting and setting specified values
+
+        //Time spent converting (defaults, specified values and candidate values following an option) for each argument (indexed by ArgumentId)
+        std::vector<Duration> argument_conversion;
+        std::vector<size_t> argument_conversions;
+
+        size_t num_tokens = 0;
+        size_t num_conversions = 0;
+
+        //Only counted if an AllocationCounter was provided
+        bool allocations_counted = false;
+        size_t num_allocations = 0;
+    };
+
+    //Adds the time until destruction to *total (does nothing if total is null)
+    class ScopedTimer {
+        public:
+            explicit ScopedTimer(ParseStats::Duration* total)
+                : total_(total) {
+                if (total_) {
+                    start_ = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~ScopedTimer() {
+                if (total_) {
+                    *total_ += std::chrono::duration_cast<ParseStats::Duration>(std::chrono::steady_clock::now() - start_);
+                }
+            }
+
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+        private:
+            ParseStats::Duration* total_;
+            std::chrono::steady_clock::time_point start_;
+    };
+
+} //namespace
+#endif
@@ -0,0 +1,11 @@
+#include "argparse_string_pool.hpp"
+
+namespace argparse {
+
+    const std::string& StringPool::intern(const std::string& str) {
+        return *strings_.insert(str).first;
+    }
+
+    size_t StringPool::size() const { return strings_.size(); }
+
+} //namespace
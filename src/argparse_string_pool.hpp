@@ -0,0 +1,58 @@
+#ifndef ARGPARSE_STRING_POOL_HPP
+#define ARGPARSE_STRING_POOL_HPP
+#include <string>
+#include <unordered_set>
+
+namespace argparse {
+
+    /*
+     * A pool of interned strings (e.g. option names, metavars and group names)
+     *
+     * Each distinct string is stored once, and the reference returned by intern()
+     * remains valid (and unchanged) for the life of the pool. This allows the
+     * same identifier to be shared (by pointer) between Arguments and ArgValues
+     * without allocating or copying.
+     */
+    class StringPool {
+        public:
+            //Returns the pooled copy of str (adding it to the pool if required)
+            const std::string& intern(const std::string& str);
+
+            //Returns the number of distinct strings in the pool
+            size_t size() const;
+        private:
+            //Node based, so references to elements are stable when the set grows
+            std::unordered_set<std::string> strings_;
+    };
+
+    //Text in static storage (e.g. a string literal), which is referenced rather than copied.
+    //It must remain valid for the life of the parser
+    struct StaticText {
+        explicit constexpr StaticText(const char* text) : str(text) {}
+
+        const char* str;
+    };
+
+    /*
+     * Descriptive text (e.g. help or an epilog), which is either owned or a view of StaticText
+     *
+     * Help text is rarely printed, so StaticText avoids copying it to the heap while the
+     * parser is defined; it is only copied (by str()) when the help is formatted.
+     */
+    class HelpText {
+        public:
+            HelpText() = default;
+            HelpText(std::string text) : owned_(std::move(text)) {}
+            HelpText(StaticText text) : static_(text.str) {}
+
+            //Returns a copy of the text
+            std::string str() const { return static_ ? std::string(static_) : owned_; }
+
+            bool empty() const { return static_ ? *static_ == '\0' : owned_.empty(); }
+        private:
+            const char* static_ = nullptr; //Referenced text (if non-null)
+            std::string owned_;
+    };
+
+} //namespace
+#endif
@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <sstream>
+
+#include "argparse_suggestion.hpp"
+
+namespace argparse {
+
+    //Maximum number of edits considered when producing suggestions
+    constexpr size_t MAX_SUGGESTION_DISTANCE = 4;
+
+    //Pattern equality bit-vectors (one bit per pattern position for each character)
+    typedef std::array<uint64_t,256> PatternMasks;
+
+    //Vertical delta bit-vectors and score (last row) of one column of the edit distance matrix
+    struct MyersState {
+        uint64_t pv; //Positive vertical deltas
+        uint64_t mv; //Negative vertical deltas
+        size_t score;
+    };
+
+    static void init_pattern_masks(const std::string& pattern, PatternMasks& peq);
+    static MyersState myers_step(const MyersState& state, const PatternMasks& peq, size_t pattern_len, char c);
+    static size_t column_min(const MyersState& state, size_t pattern_len, size_t depth);
+    static size_t dp_edit_distance(const std::string& str, const char* text, size_t text_len, size_t max_distance);
+    static size_t suggestion_bound(size_t str_len, size_t candidate_len);
+
+    /*
+     * SuggestionIndex
+     */
+    SuggestionIndex::SuggestionIndex(const std::vector<std::string>& candidates) {
+        std::vector<const std::string*> sorted;
+        sorted.reserve(candidates.size());
+        size_t total_len = 0;
+        for (const auto& candidate : candidates) {
+            sorted.push_back(&candidate);
+            total_len += candidate.size();
+            max_length_ = std::max(max_length_, candidate.size());
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const std::string* lhs, const std::string* rhs) {
+            return *lhs < *rhs;
+        });
+
+        text_.reserve(total_len);
+        entries_.reserve(sorted.size());
+        const std::string* prev = nullptr;
+        for (const std::string* str : sorted) {
+            size_t shared = 0;
+            if (prev) {
+                size_t max_shared = std::min(prev->size(), str->size());
+                while (shared < max_shared && (*prev)[shared] == (*str)[shared]) {
+                    ++shared;
+                }
+            }
+            entries_.push_back({uint32_t(text_.size()), uint32_t(str->size()), uint32_t(shared)});
+            text_.append(*str);
+            prev = str;
+        }
+    }
+
+    std::vector<std::string> SuggestionIndex::suggest(const std::string& str, size_t max_results) const {
+        if (entries_.empty() || max_results == 0 || str.empty()) return {};
+
+        if (str.size() > 64) {
+            return suggest_long(str, max_results);
+        }
+
+        const size_t m = str.size();
+        PatternMasks peq;
+        init_pattern_masks(str, peq);
+
+        //Bit-vector state after each prefix length of the current candidate.
+        //Depth zero is the empty prefix, whose column is 0, 1, ..., m.
+        std::vector<MyersState> states(max_length_ + 1);
+        states[0] = {~uint64_t(0), 0, m};
+        size_t valid_depth = 0; //Deepest state which is valid for the current candidate
+
+        //No candidate, however long, may exceed this bound
+        size_t prune_bound = suggestion_bound(m, std::max(m, max_length_));
+
+        std::vector<std::pair<size_t,uint32_t>> best; //(distance, entry) sorted by distance
+        best.reserve(max_results + 1);
+
+        size_t ientry = 0;
+        while (ientry < entries_.size()) {
+            const Entry& entry = entries_[ientry];
+            const char* text = text_.data() + entry.offset;
+
+            size_t depth = std::min<size_t>(valid_depth, entry.shared_prefix);
+
+            size_t len_diff = (m > entry.length) ? m - entry.length : entry.length - m;
+            size_t bound = std::min(suggestion_bound(m, entry.length), prune_bound);
+            if (bound == 0 || len_diff > bound) {
+                //Length alone rules this candidate out
+                valid_depth = depth;
+                ++ientry;
+                continue;
+            }
+
+            bool pruned = false;
+            for (; depth < entry.length; ++depth) {
+                states[depth + 1] = myers_step(states[depth], peq, m, text[depth]);
+
+                if (column_min(states[depth + 1], m, depth + 1) > prune_bound) {
+                    //No candidate with this prefix can be within the bound
+                    pruned = true;
+                    break;
+                }
+            }
+            valid_depth = depth + (pruned ? 1 : 0);
+
+            if (pruned) {
+                //Skip all later entries sharing the pruned prefix
+                size_t prefix_len = valid_depth;
+                do {
+                    ++ientry;
+                } while (ientry < entries_.size() && entries_[ientry].shared_prefix >= prefix_len);
+                continue;
+            }
+
+            size_t dist = states[entry.length].score;
+            if (dist > 0 && dist <= bound) {
+                auto pos = std::upper_bound(best.begin(), best.end(), std::make_pair(dist, std::numeric_limits<uint32_t>::max()));
+                best.insert(pos, std::make_pair(dist, uint32_t(ientry)));
+                if (best.size() > max_results) {
+                    best.pop_back();
+                }
+                if (best.size() == max_results) {
+                    //Only strictly closer candidates can now be suggested
+                    prune_bound = std::min(prune_bound, best.back().first - 1);
+                }
+            }
+            ++ientry;
+        }
+
+        std::vector<std::string> suggestions;
+        for (const auto& match : best) {
+            const Entry& entry = entries_[match.second];
+            suggestions.emplace_back(text_, entry.offset, entry.length);
+        }
+        return suggestions;
+    }
+
+    std::vector<std::string> SuggestionIndex::suggest_long(const std::string& str, size_t max_results) const {
+        //Patterns too long for a single bit-vector fall back to banded dynamic programming
+        std::vector<std::pair<size_t,uint32_t>> matches; //(distance, entry)
+        for (size_t ientry = 0; ientry < entries_.size(); ++ientry) {
+            const Entry& entry = entries_[ientry];
+            size_t bound = suggestion_bound(str.size(), entry.length);
+            size_t len_diff = (str.size() > entry.length) ? str.size() - entry.length : entry.length - str.size();
+            if (len_diff > bound) continue;
+
+            size_t dist = dp_edit_distance(str, text_.data() + entry.offset, entry.length, bound);
+            if (dist > 0 && dist <= bound) {
+                matches.emplace_back(dist, uint32_t(ientry));
+            }
+        }
+
+        size_t num_results = std::min(max_results, matches.size());
+        std::partial_sort(matches.begin(), matches.begin() + num_results, matches.end());
+
+        std::vector<std::string> suggestions;
+        for (size_t i = 0; i < num_results; ++i) {
+            const Entry& entry = entries_[matches[i].second];
+            suggestions.emplace_back(text_, entry.offset, entry.length);
+        }
+        return suggestions;
+    }
+
+    bool SuggestionIndex::empty() const { return entries_.empty(); }
+
+    std::string did_you_mean(const std::vector<std::string>& suggestions) {
+        if (suggestions.empty()) return "";
+
+        std::stringstream ss;
+        ss << " (did you mean ";
+        if (suggestions.size() > 1) {
+            ss << "one of: ";
+        }
+        bool first = true;
+        for (const auto& suggestion : suggestions) {
+            if (!first) ss << ", ";
+            ss << "'" << suggestion << "'";
+            first = false;
+        }
+        ss << "?)";
+        return ss.str();
+    }
+
+    /*
+     * Utilities
+     */
+    static void init_pattern_masks(const std::string& pattern, PatternMasks& peq) {
+        peq.fill(0);
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            peq[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+        }
+    }
+
+    static MyersState myers_step(const MyersState& state, const PatternMasks& peq, size_t pattern_len, char c) {
+        const uint64_t high_bit = uint64_t(1) << (pattern_len - 1);
+
+        uint64_t eq = peq[static_cast<unsigned char>(c)];
+        uint64_t xv = eq | state.mv;
+        uint64_t xh = (((eq & state.pv) + state.pv) ^ state.pv) | eq;
+        uint64_t ph = state.mv | ~(xh | state.pv);
+        uint64_t mh = state.pv & xh;
+
+        MyersState next;
+        next.score = state.score;
+        if (ph & high_bit) {
+            ++next.score;
+        } else if (mh & high_bit) {
+            --next.score;
+        }
+
+        //Edit distance (rather than substring search) so the top row increases by one each column
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        next.pv = mh | ~(xv | ph);
+        next.mv = ph & xv;
+        return next;
+    }
+
+    static size_t column_min(const MyersState& state, size_t pattern_len, size_t depth) {
+        //The top of the column is the prefix length, and each pattern position
+        //changes the distance by the vertical delta recorded in pv/mv
+        size_t value = depth;
+        size_t min_value = depth;
+        for (size_t i = 0; i < pattern_len; ++i) {
+            value += (state.pv >> i) & 1;
+            value -= (state.mv >> i) & 1;
+            min_value = std::min(min_value, value);
+        }
+        return min_value;
+    }
+
+    static size_t dp_edit_distance(const std::string& str, const char* text, size_t text_len, size_t max_distance) {
+        std::vector<size_t> prev(text_len + 1);
+        std::vector<size_t> curr(text_len + 1);
+        for (size_t j = 0; j <= text_len; ++j) {
+            prev[j] = j;
+        }
+
+        for (size_t i = 1; i <= str.size(); ++i) {
+            curr[0] = i;
+            size_t row_min = curr[0];
+            for (size_t j = 1; j <= text_len; ++j) {
+                size_t cost = (str[i - 1] == text[j - 1]) ? 0 : 1;
+                curr[j] = std::min({prev[j] + 1, curr[j - 1] + 1, prev[j - 1] + cost});
+                row_min = std::min(row_min, curr[j]);
+            }
+            if (row_min > max_distance) {
+                return max_distance + 1;
+            }
+            std::swap(prev, curr);
+        }
+
+        return (prev[text_len] <= max_distance) ? prev[text_len] : max_distance + 1;
+    }
+
+    static size_t suggestion_bound(size_t str_len, size_t candidate_len) {
+        //Allow roughly one edit per three characters, so very short
+        //strings (e.g. single letter choices) are not suggested
+        return std::min(std::max(str_len, candidate_len) / 3, MAX_SUGGESTION_DISTANCE);
+    }
+
+} //namespace
@@ -0,0 +1,49 @@
+#ifndef ARGPARSE_SUGGESTION_HPP
+#define ARGPARSE_SUGGESTION_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace argparse {
+
+    /*
+     * A pre-computed index of candidate strings (e.g. option names or choices)
+     * used to produce 'did you mean' suggestions for mis-typed values.
+     *
+     * Candidates are stored sorted in a single buffer along with the length of
+     * the prefix each shares with its predecessor. The distance is calculated
+     * with Myers' bit-parallel algorithm (Hyyro's formulation for edit distance)
+     * walking the candidates as an implicit trie: the bit-vector state of a
+     * shared prefix is re-used, and all candidates sharing a prefix are skipped
+     * once that prefix can no longer be within the edit bound.
+     */
+    class SuggestionIndex {
+        public:
+            SuggestionIndex() = default;
+            SuggestionIndex(const std::vector<std::string>& candidates);
+
+            //Returns up to max_results candidates closest to str (closest first).
+            //Only candidates within a length dependent edit bound are returned.
+            std::vector<std::string> suggest(const std::string& str, size_t max_results=3) const;
+
+            //Returns true if the index has no candidates
+            bool empty() const;
+        private:
+            std::vector<std::string> suggest_long(const std::string& str, size_t max_results) const;
+        private:
+            struct Entry {
+                uint32_t offset;
+                uint32_t length;
+                uint32_t shared_prefix; //Length of the prefix shared with the previous entry
+            };
+            std::string text_; //All candidates concatenated in sorted order
+            std::vector<Entry> entries_; //Sorted lexicographically
+            size_t max_length_ = 0; //Length of the longest candidate
+    };
+
+    //Returns a ' (did you mean ...?)' message fragment for the specified suggestions,
+    //or an empty string if there are none
+    std::string did_you_mean(const std::vector<std::string>& suggestions);
+
+} //namespace
+#endif
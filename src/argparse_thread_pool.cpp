@@ -0,0 +1,55 @@
+#include "argparse_thread_pool.hpp"
+
+namespace argparse {
+
+    ThreadPool::ThreadPool(size_t num_threads) {
+        if (num_threads == 0) {
+            num_threads = 1;
+        }
+        workers_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back(&ThreadPool::run_worker, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        task_queued_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    std::future<void> ThreadPool::submit(std::function<void()> task) {
+        std::packaged_task<void()> packaged_task(std::move(task));
+        std::future<void> done = packaged_task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(packaged_task));
+        }
+        task_queued_.notify_one();
+        return done;
+    }
+
+    size_t ThreadPool::size() const { return workers_.size(); }
+
+    void ThreadPool::run_worker() {
+        while (true) {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                task_queued_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return; //Stopping, and no work remains
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+} //namespace
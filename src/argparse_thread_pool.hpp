@@ -0,0 +1,44 @@
+#ifndef ARGPARSE_THREAD_POOL_HPP
+#define ARGPARSE_THREAD_POOL_HPP
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace argparse {
+
+    /*
+     * A fixed set of worker threads which run queued tasks
+     * (used to run asynchronous conversions, see ArgumentParser::async_conversion_threads())
+     */
+    class ThreadPool {
+        public:
+            //Starts num_threads workers (at least one)
+            explicit ThreadPool(size_t num_threads);
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            //Runs any tasks still queued, then stops the workers
+            ~ThreadPool();
+
+            //Queues task to run on a worker, returning a future which is ready once it has run
+            std::future<void> submit(std::function<void()> task);
+
+            //Returns the number of workers
+            size_t size() const;
+        private:
+            void run_worker();
+        private:
+            std::vector<std::thread> workers_;
+            std::deque<std::packaged_task<void()>> tasks_;
+            std::mutex mutex_;
+            std::condition_variable task_queued_;
+            bool stopping_ = false;
+    };
+
+} //namespace
+#endif
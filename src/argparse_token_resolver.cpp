@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <sstream>
+
+#include "argparse_util.hpp"
+#include "argparse_token_resolver.hpp"
+#include "argparse_error.hpp"
+#include "argparse_stats.hpp"
+#include "argparse_suggestion.hpp"
+#include "argparse_token_source.hpp"
+
+namespace argparse {
+
+    /*
+     * OptionTable
+     */
+    void OptionTable::add(ArgumentId id, bool positional, const std::string& long_opt, const std::string& short_opt) {
+        if (positional) {
+            positional_args.push_back(id);
+            return;
+        }
+
+        for (const std::string* opt : {&long_opt, &short_opt}) {
+            if (opt->empty()) continue;
+
+            auto ret = str_to_option_arg.insert(std::make_pair(*opt, id));
+
+            if (!ret.second) {
+                //Option string already specified
+                std::stringstream ss;
+                ss << "Option string '" << *opt << "' maps to multiple options";
+                throw ArgParseError(ss.str());
+            }
+            short_options.add(*opt, id);
+        }
+    }
+
+    /*
+     * TokenResolver
+     */
+    TokenResolver::TokenResolver(const ArgumentMetadata& args, const OptionTable& options)
+        : args_(args)
+        , hot_table_(args.hot_table())
+        , options_(options) {}
+
+    int TokenResolver::resolve(TokenSource& tokens, ParseStats* stats) {
+        const auto& positional_args = options_.positional_args;
+        for (size_t i = 0; i + 1 < positional_args.size(); ++i) {
+            if (hot_table_[positional_args[i]].nargs != '1') {
+                //Would take all the following positionals' values
+                throw ArgParseError("Only the last positional argument may take multiple values (" + args_.argument_name(positional_args[i]) + ")");
+            }
+        }
+        size_t next_positional = 0;
+
+        //Process the arguments
+        ScopedTimer resolution_timer(stats ? &stats->token_resolution : nullptr);
+        std::string arg_str;
+        std::string short_option_str; //The last short option of a short option token
+        bool options_ended = false; //After '--' all arguments are positional (or a sub-command)
+        while (tokens.next(arg_str)) {
+            ArgumentId arg_id = NO_ARGUMENT_ID;
+            size_t value_offset = 0; //Offset of the value attached to a short option (0 if none)
+
+            if (options_ended) {
+                //Not an option
+            } else if (arg_str == END_OF_OPTIONS) {
+                options_ended = true;
+                continue;
+            } else {
+                auto iter = options_.str_to_option_arg.find(arg_str);
+                if (iter != options_.str_to_option_arg.end()) {
+                    //Full argument
+                    arg_id = iter->second;
+                } else if (arg_str.size() > 2 && options_.short_options.starts_option(arg_str)) {
+                    //Short argument with no space before its value, or a cluster of short flags
+                    arg_id = decode_short_options(arg_str, value_offset);
+                    short_option_str.assign({'-', arg_str[value_offset - 1]});
+                }
+            }
+            const std::string& option_str = value_offset ? short_option_str : arg_str;
+
+            if (arg_id != NO_ARGUMENT_ID) {
+                //Start of an argument
+                const ArgumentHot& hot = hot_table_[arg_id];
+
+                if (hot.action != Action::STORE) {
+                    //STORE_TRUE, STORE_FALSE, HELP or VERSION, which take no values
+                    on_option(arg_id, option_str);
+                    continue;
+                }
+
+                size_t max_values_to_read = 0;
+                size_t min_values_to_read = 0;
+                if (hot.nargs == '1') {
+                    max_values_to_read = 1;
+                    min_values_to_read = 1;
+                } else if (hot.nargs == '*') {
+                    max_values_to_read = std::numeric_limits<size_t>::max();
+                    min_values_to_read = 0;
+                } else if (hot.nargs == '+') {
+                    max_values_to_read = std::numeric_limits<size_t>::max();
+                    min_values_to_read = 1;
+                } else {
+                    std::stringstream msg;
+                    msg << "Unsupport nargs value '" << hot.nargs << "'";
+                    throw ArgParseError(msg.str());
+                }
+
+                size_t nargs_read = 0;
+                const std::string* rejected_value = nullptr; //Candidate value which failed validation
+                on_option(arg_id, option_str);
+                if (value_offset && value_offset < arg_str.size()) {
+                    //It is a short argument, we already have the first value
+                    std::string value = arg_str.substr(value_offset);
+                    if (hot.has(ArgumentHot::HAS_CHOICES)) {
+                        ScopedTimer timer(stats ? &stats->choice_validation : nullptr);
+                        if (!is_valid_choice(value, args_.argument_choices(arg_id))) {
+                            throw ArgParseError(invalid_choice_message(arg_id, value));
+                        }
+                    }
+                    on_value(arg_id, value);
+                    ++nargs_read;
+                }
+
+                {
+                    //Values following the option (which are converted, and checked against any choices)
+                    ScopedTimer timer(stats ? &stats->lookahead : nullptr);
+                    for (; nargs_read < max_values_to_read; ++nargs_read) {
+                        const std::string* str = tokens.peek();
+                        if (!str) break;
+
+                        if (*str == END_OF_OPTIONS || is_argument(*str, options_.str_to_option_arg, options_.short_options)) break;
+
+                        if (!is_valid_value(arg_id, *str, stats)) {
+                            rejected_value = str;
+                            break;
+                        }
+
+                        on_value(arg_id, *str);
+                        tokens.skip();
+                    }
+                }
+
+                if (nargs_read < min_values_to_read) {
+
+                    if (rejected_value && !is_valid_choice(*rejected_value, args_.argument_choices(arg_id))) {
+                        //A value was provided, but it was not one of the valid choices
+                        throw ArgParseError(invalid_choice_message(arg_id, *rejected_value));
+                    } else if (rejected_value && hot.delimiter) {
+                        //A delimited list was provided, report the invalid field
+                        throw ArgParseConversionError(args_.field_error(arg_id, *rejected_value) + " for " + args_.argument_name(arg_id));
+                    } else if (hot.nargs == '1') {
+                        std::stringstream msg;
+                        msg << "Missing expected argument for " << option_str;
+                        throw ArgParseError(msg.str());
+
+                    } else {
+                        std::stringstream msg;
+                        msg << "Expected at least " << min_values_to_read << " value";
+                        if (min_values_to_read > 1) {
+                            msg << "s";
+                        }
+                        msg << " for argument '" << option_str << "'";
+                        msg << " (found " << nargs_read << ")";
+                        throw ArgParseError(msg.str());
+                    }
+                }
+                assert (nargs_read <= max_values_to_read);
+
+            } else {
+                bool positionals_remaining = next_positional < positional_args.size();
+                if (!positionals_remaining && !args_.subcommand_names().empty()) {
+                    //Sub-command, which resolves all remaining arguments
+                    int subcommand = find_subcommand(arg_str);
+                    on_subcommand(subcommand, arg_str);
+                    return subcommand;
+                } else if (!positionals_remaining) {
+                    //Unrecognized
+                    std::stringstream ss;
+                    ss << "Unexpected command-line argument '" << arg_str << "'";
+                    ss << did_you_mean(args_.suggest_options(arg_str, options_));
+                    throw ArgParseError(ss.str());
+                } else {
+                    //Positional argument (a multi value positional takes all the remaining positional values)
+                    ArgumentId positional = positional_args[next_positional];
+                    if (hot_table_[positional].nargs == '1') {
+                        ++next_positional;
+                    }
+                    on_positional(positional, arg_str);
+                }
+            }
+        }
+
+        return -1;
+    }
+
+    ArgumentId TokenResolver::decode_short_options(const std::string& str, size_t& value_offset) {
+        for (size_t pos = 1; pos < str.size(); ++pos) {
+            ArgumentId arg_id = options_.short_options.find(str[pos]);
+            if (arg_id == NO_ARGUMENT_ID) {
+                std::stringstream msg;
+                msg << "Unexpected short option '-" << str[pos] << "' in '" << str << "'";
+                throw ArgParseError(msg.str());
+            }
+
+            value_offset = pos + 1;
+            if (hot_table_[arg_id].action == Action::STORE || value_offset == str.size()) {
+                //The remainder of str is the option's value, or this is the last flag of the cluster
+                return arg_id;
+            }
+
+            //A flag (taking no value) followed by further short options
+            char option_str[3] = {'-', str[pos], '\0'};
+            on_option(arg_id, option_str);
+        }
+        assert(false);
+        return NO_ARGUMENT_ID;
+    }
+
+    int TokenResolver::find_subcommand(const std::string& name) const {
+        std::vector<std::string> names = args_.subcommand_names();
+        auto iter = std::find(names.begin(), names.end(), name);
+        if (iter == names.end()) {
+            std::stringstream msg;
+            msg << "Unexpected sub-command '" << name << "' (expected one of: " << join(names, ", ") << ")";
+            msg << did_you_mean(SuggestionIndex(names).suggest(name));
+            throw ArgParseError(msg.str());
+        }
+        return int(iter - names.begin());
+    }
+
+    std::string TokenResolver::invalid_choice_message(ArgumentId id, const std::string& value) const {
+        std::stringstream msg;
+        msg << "Unexpected option value '" << value << "' (expected one of: " << join(args_.argument_choices(id), ", ");
+        msg << ") for " << args_.argument_name(id);
+        msg << did_you_mean(args_.suggest_choices(id, value));
+        return msg.str();
+    }
+
+    bool TokenResolver::is_valid_value(ArgumentId id, const std::string& value, ParseStats* stats) const {
+        {
+            ScopedTimer timer(stats ? &stats->argument_conversion[id] : nullptr);
+            if (stats) {
+                ++stats->argument_conversions[id];
+                ++stats->num_conversions;
+            }
+            if (!args_.is_convertible_value(id, value)) return false;
+        }
+
+        const ArgumentHot& hot = hot_table_[id];
+        if (hot.has(ArgumentHot::HAS_CHOICES) && !hot.delimiter) { //The fields of delimited values are not choices
+            ScopedTimer timer(stats ? &stats->choice_validation : nullptr);
+            return is_valid_choice(value, args_.argument_choices(id));
+        }
+        return true;
+    }
+
+    /*
+     * Utilities
+     */
+    void check_required_arguments(const ArgumentMetadata& args, const std::vector<bool>& specified_arguments, bool subcommand_selected) {
+        const auto& hot_table = args.hot_table();
+
+        //Missing positionals? (reported before other missing arguments)
+        for (size_t id = 0; id < hot_table.size(); ++id) {
+            if (!hot_table[id].has(ArgumentHot::POSITIONAL)) continue;
+
+            if (hot_table[id].has(ArgumentHot::REQUIRED) && !specified_arguments[id]) {
+                throw ArgParseError("Missing required positional argument: " + args.argument_name(ArgumentId(id)));
+            }
+        }
+
+        //Missing sub-command?
+        if (args.subcommand_required() && !subcommand_selected) {
+            std::vector<std::string> names = args.subcommand_names();
+            if (!names.empty()) {
+                throw ArgParseError("Missing required sub-command (expected one of: " + join(names, ", ") + ")");
+            }
+        }
+
+        //Missing required?
+        for (size_t id = 0; id < hot_table.size(); ++id) {
+            if (hot_table[id].has(ArgumentHot::REQUIRED) && !specified_arguments[id]) {
+                throw ArgParseError("Missing required argument: " + args.argument_name(ArgumentId(id)));
+            }
+        }
+    }
+
+} //namespace
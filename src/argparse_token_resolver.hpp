@@ -0,0 +1,130 @@
+#ifndef ARGPARSE_TOKEN_RESOLVER_HPP
+#define ARGPARSE_TOKEN_RESOLVER_HPP
+#include <map>
+#include <string>
+#include <vector>
+
+#include "argparse_argument_table.hpp"
+#include "argparse_util.hpp"
+#include "argparse_value.hpp"
+
+namespace argparse {
+
+    class TokenSource;
+    struct ParseStats;
+
+    //Ends the options of a command-line (and the values of the preceding option):
+    //all following arguments are positional (or a sub-command)
+    constexpr const char* END_OF_OPTIONS = "--";
+
+    //Look-ups of a parser's option strings and positional arguments
+    struct OptionTable {
+        std::map<std::string,ArgumentId> str_to_option_arg;
+        ShortOptionTable short_options;
+        std::vector<ArgumentId> positional_args;
+
+        //Adds the argument with the specified ID.
+        //Throws ArgParseError if one of its option strings is already used
+        void add(ArgumentId id, bool positional, const std::string& long_opt, const std::string& short_opt);
+    };
+
+    /*
+     * The definitions of a parser's arguments, as needed to check command-lines
+     *
+     * Implemented by ArgumentParser (over its argument table) and ParserSchema (over
+     * its saved definitions), so both resolve and check command-lines with the same
+     * routines (see TokenResolver and check_required_arguments()).
+     */
+    class ArgumentMetadata {
+        public:
+            virtual ~ArgumentMetadata() = default;
+
+            //Returns the parse-time metadata of all arguments (indexed by ArgumentId)
+            virtual const std::vector<ArgumentHot>& hot_table() const = 0;
+
+            //Returns the descriptive name of the argument (e.g. '--jobs/-j')
+            virtual const std::string& argument_name(ArgumentId id) const = 0;
+
+            //Returns the argument's valid choices (empty if any value is valid)
+            virtual const std::vector<std::string>& argument_choices(ArgumentId id) const = 0;
+
+            //Returns the argument's choices closest to value
+            virtual std::vector<std::string> suggest_choices(ArgumentId id, const std::string& value) const = 0;
+
+            //Returns true if value converts to the argument's type (as does each field of a delimited value).
+            //Choices are checked separately (see argument_choices())
+            virtual bool is_convertible_value(ArgumentId id, const std::string& value) const = 0;
+
+            //Returns the error describing the first invalid field of a delimited value of the argument
+            virtual std::string field_error(ArgumentId id, const std::string& value) const = 0;
+
+            //Returns the option strings (of options) closest to str
+            virtual std::vector<std::string> suggest_options(const std::string& str, const OptionTable& options) const = 0;
+
+            //Returns the names of the parser's sub-commands
+            virtual std::vector<std::string> subcommand_names() const = 0;
+
+            //Returns true if one of the sub-commands must be specified
+            virtual bool subcommand_required() const = 0;
+    };
+
+    /*
+     * Resolves command-line tokens into the options, values, positional arguments and
+     * sub-command they specify, checking the number of values and their choices
+     *
+     * Shared by ArgumentParser (which then converts the values) and ParserSchema (which
+     * only checks them). Subclasses are notified of each resolved token.
+     */
+    class TokenResolver {
+        public:
+            TokenResolver(const ArgumentMetadata& args, const OptionTable& options);
+            TokenResolver(const TokenResolver&) = delete;
+            TokenResolver& operator=(const TokenResolver&) = delete;
+            virtual ~TokenResolver() = default;
+
+            //Resolves tokens, stopping after a sub-command and returning its index (or -1 if there
+            //was none). Throws ArgParseError if they are invalid. If stats is non-null the time spent
+            //(and the values checked) are added to it
+            int resolve(TokenSource& tokens, ParseStats* stats);
+
+        protected:
+            //An option (e.g. '--foo', or the '-f' of '-f3') which specifies the argument
+            virtual void on_option(ArgumentId id, const std::string& option_str) = 0;
+
+            //A value of the most recent option
+            virtual void on_value(ArgumentId id, const std::string& value) = 0;
+
+            //A value of a positional argument
+            virtual void on_positional(ArgumentId id, const std::string& value) = 0;
+
+            //A sub-command, which is followed by its own arguments
+            virtual void on_subcommand(int index, const std::string& name) = 0;
+
+        private:
+            //Decodes a token starting with a short option: either a short option with its value attached
+            //(e.g. '-j3'), or a cluster of short flags (e.g. '-abc' for '-a -b -c') where the last option may
+            //take a value (e.g. '-abj3'). Reports each flag but the last, and returns the last option,
+            //setting value_offset to the offset of its attached value (str's length if there is none)
+            ArgumentId decode_short_options(const std::string& str, size_t& value_offset);
+
+            //Returns the index of the sub-command name, throwing ArgParseError if there is none
+            int find_subcommand(const std::string& name) const;
+
+            //Returns the error message for a value which is not one of the argument's choices
+            std::string invalid_choice_message(ArgumentId id, const std::string& value) const;
+
+            //Returns true if value (following an option) converts for the argument, and is one of its choices.
+            //The conversion is charged to the argument, and the choice check timed, in stats (if non-null)
+            bool is_valid_value(ArgumentId id, const std::string& value, ParseStats* stats) const;
+        private:
+            const ArgumentMetadata& args_;
+            const std::vector<ArgumentHot>& hot_table_;
+            const OptionTable& options_;
+    };
+
+    //Throws ArgParseError if a required argument of args (or a required sub-command) was not specified.
+    //Missing positional arguments are reported first
+    void check_required_arguments(const ArgumentMetadata& args, const std::vector<bool>& specified_arguments, bool subcommand_selected);
+
+} //namespace
+#endif
@@ -0,0 +1,121 @@
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include "argparse_token_source.hpp"
+#include "argparse_error.hpp"
+
+namespace argparse {
+
+    /*
+     * TokenSource
+     */
+    bool TokenSource::next(std::string& token) {
+        if (has_lookahead_) {
+            token.swap(lookahead_);
+            has_lookahead_ = false;
+        } else if (!read(token)) {
+            return false;
+        }
+        ++position_;
+        return true;
+    }
+
+    const std::string* TokenSource::peek() {
+        if (!has_lookahead_) {
+            has_lookahead_ = read(lookahead_);
+        }
+        return has_lookahead_ ? &lookahead_ : nullptr;
+    }
+
+    void TokenSource::skip() {
+        if (!peek()) return;
+        has_lookahead_ = false;
+        ++position_;
+    }
+
+    size_t TokenSource::position() const { return position_; }
+
+    /*
+     * ArgvTokenSource
+     */
+    ArgvTokenSource::ArgvTokenSource(int argc, const char* const* argv)
+        : argc_(argc)
+        , argv_(argv) {}
+
+    bool ArgvTokenSource::read(std::string& token) {
+        if (next_ >= argc_) return false;
+        token = argv_[next_++];
+        return true;
+    }
+
+    /*
+     * VectorTokenSource
+     */
+    VectorTokenSource::VectorTokenSource(std::vector<std::string> args)
+        : args_(std::move(args)) {}
+
+    bool VectorTokenSource::read(std::string& token) {
+        if (next_ >= args_.size()) return false;
+        token = std::move(args_[next_++]);
+        return true;
+    }
+
+    /*
+     * FdTokenSource
+     */
+    FdTokenSource::FdTokenSource(int fd, char delimiter, size_t buffer_size)
+        : fd_(fd)
+        , delimiter_(delimiter)
+        , buffer_(new char[buffer_size > 0 ? buffer_size : 1])
+        , buffer_size_(buffer_size > 0 ? buffer_size : 1) {}
+
+    bool FdTokenSource::read(std::string& token) {
+        token.clear();
+        while (begin_ < end_ || fill()) {
+            const char* begin = buffer_.get() + begin_;
+            const char* delim = static_cast<const char*>(std::memchr(begin, delimiter_, end_ - begin_));
+            if (delim) {
+                token.append(begin, delim);
+                begin_ += (delim - begin) + 1;
+                return true;
+            }
+
+            //Token continues into the next read
+            token.append(begin, end_ - begin_);
+            begin_ = end_;
+        }
+        return !token.empty(); //Final token without a delimiter
+    }
+
+    bool FdTokenSource::fill() {
+        if (eof_) return false;
+
+        while (true) {
+#ifndef _WIN32
+            auto num_read = ::read(fd_, buffer_.get(), buffer_size_);
+#else
+            auto num_read = ::_read(fd_, buffer_.get(), unsigned(buffer_size_));
+#endif
+            if (num_read < 0) {
+                if (errno == EINTR) continue;
+
+                std::stringstream msg;
+                msg << "Failed to read command-line arguments from file descriptor " << fd_ << ": " << std::strerror(errno);
+                throw ArgParseError(msg.str());
+            }
+
+            begin_ = 0;
+            end_ = size_t(num_read);
+            eof_ = (num_read == 0);
+            return !eof_;
+        }
+    }
+
+} //namespace
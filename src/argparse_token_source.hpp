@@ -0,0 +1,96 @@
+#ifndef ARGPARSE_TOKEN_SOURCE_HPP
+#define ARGPARSE_TOKEN_SOURCE_HPP
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace argparse {
+
+    /*
+     * A source of command-line arguments, which are read one at a time as they are parsed
+     * (see ArgumentParser::parse_args_throw(TokenSource&))
+     *
+     * At most one token is read ahead of the parser, so a long command-line need
+     * never be held in memory all at once.
+     */
+    class TokenSource {
+        public:
+            TokenSource() = default;
+            TokenSource(const TokenSource&) = delete;
+            TokenSource& operator=(const TokenSource&) = delete;
+            virtual ~TokenSource() = default;
+
+            //Moves the next token into token, returning false if there are no more
+            bool next(std::string& token);
+
+            //Returns the next token without consuming it (or nullptr if there are no more).
+            //The token remains valid until the next call to next() or skip()
+            const std::string* peek();
+
+            //Discards the next token
+            void skip();
+
+            //Returns the number of tokens consumed (by next() or skip())
+            size_t position() const;
+        protected:
+            //Reads the next token into token, returning false if there are no more
+            virtual bool read(std::string& token) = 0;
+        private:
+            std::string lookahead_;
+            bool has_lookahead_ = false;
+            size_t position_ = 0;
+    };
+
+    //The arguments of main() (excluding the program name argv[0])
+    class ArgvTokenSource : public TokenSource {
+        public:
+            ArgvTokenSource(int argc, const char* const* argv);
+        protected:
+            bool read(std::string& token) override;
+        private:
+            int argc_;
+            const char* const* argv_;
+            int next_ = 1;
+    };
+
+    //Arguments held in a vector (which are moved out as they are read)
+    class VectorTokenSource : public TokenSource {
+        public:
+            explicit VectorTokenSource(std::vector<std::string> args);
+        protected:
+            bool read(std::string& token) override;
+        private:
+            std::vector<std::string> args_;
+            size_t next_ = 0;
+    };
+
+    /*
+     * Arguments read from a file descriptor (e.g. stdin, or a pipe), each terminated by delimiter
+     *
+     * The default NUL delimiter matches the output of 'find -print0' and 'xargs -0', and
+     * '\n' reads one argument per line. A final argument without a delimiter is also read
+     * (if non-empty). Input is read through a buffer of buffer_size bytes, so the
+     * number of arguments is not limited by the system's maximum command-line length.
+     */
+    class FdTokenSource : public TokenSource {
+        public:
+            explicit FdTokenSource(int fd, char delimiter='\0', size_t buffer_size=64*1024);
+        protected:
+            //Throws ArgParseError if the file descriptor can not be read
+            bool read(std::string& token) override;
+        private:
+            //Refills the buffer, returning false at the end of the input
+            bool fill();
+        private:
+            int fd_;
+            char delimiter_;
+            std::unique_ptr<char[]> buffer_;
+            size_t buffer_size_;
+            size_t begin_ = 0; //Start of the unread data in buffer_
+            size_t end_ = 0; //End of the unread data in buffer_
+            bool eof_ = false;
+    };
+
+} //namespace
+#endif
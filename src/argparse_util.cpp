@@ -17,29 +17,21 @@ namespace argparse {
         return array;
     }
 
-    bool is_argument(std::string str, const std::map<std::string,std::shared_ptr<Argument>>& arg_map) {
-
-        for (const auto& kv : arg_map) {
-            auto iter = arg_map.find(str);
-
-            if (iter != arg_map.end()) {
-                //Exact match to short/long option
-                return true;
-            }
-
-            if (kv.first.size() == 2 && kv.first[0] == '-') {
-                //Check iff this is a short option with no spaces
-                if (str[0] == kv.first[0] && str[1] == kv.first[1]) {
-                    //Matches first two characters
-                    return true;
-                }
-            }
+    ShortOptionTable::ShortOptionTable() {
+        table_.fill(NO_ARGUMENT_ID);
+    }
 
+    void ShortOptionTable::add(const std::string& opt, ArgumentId id) {
+        if (opt.size() == 2 && opt[0] == '-') {
+            table_[static_cast<unsigned char>(opt[1])] = id;
         }
-        return false;
     }
 
-    bool is_valid_choice(std::string str, const std::vector<std::string>& choices) {
+    bool is_argument(const std::string& str, const std::map<std::string,ArgumentId>& arg_map, const ShortOptionTable& short_options) {
+        return short_options.starts_option(str) || arg_map.count(str);
+    }
+
+    bool is_valid_choice(const std::string& str, const std::vector<std::string>& choices) {
         if (choices.empty()) return true;
 
         auto find_iter = std::find(choices.begin(), choices.end(), str);
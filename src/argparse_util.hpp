@@ -6,8 +6,9 @@
 #include <memory>
 #include <string>
 
+#include "argparse_value.hpp"
+
 namespace argparse {
-    class Argument;
 
     //Splits off the leading dashes of a string, returning the dashes (index 0)
     //and the rest of the string (index 1)
@@ -19,12 +20,34 @@ namespace argparse {
     //Converts a string to lower case
     std::string tolower(std::string str);
 
-    //Returns true if str represents a named argument starting with
-    //'-' or '--' followed by one or more letters
-    bool is_argument(std::string str, const std::map<std::string,std::shared_ptr<Argument>>& arg_map);
+    /*
+     * Look-up of short options (a dash and a single character, e.g. '-j') indexed by their character,
+     * so a token can be matched against all the short options without searching
+     */
+    class ShortOptionTable {
+        public:
+            ShortOptionTable();
+
+            //Adds opt (ignored if it is not a short option)
+            void add(const std::string& opt, ArgumentId id);
+
+            //Returns the argument of the short option '-c' (or NO_ARGUMENT_ID if there is none)
+            ArgumentId find(char c) const { return table_[static_cast<unsigned char>(c)]; }
+
+            //Returns true if str starts with a short option (e.g. '-j', '-j3' or '-abc')
+            bool starts_option(const std::string& str) const {
+                return str.size() >= 2 && str[0] == '-' && find(str[1]) != NO_ARGUMENT_ID;
+            }
+        private:
+            std::array<ArgumentId,256> table_;
+    };
+
+    //Returns true if str is an option in arg_map, or starts with a short option
+    //(i.e. is a short option of short_options, or one followed by its value or further short options)
+    bool is_argument(const std::string& str, const std::map<std::string,ArgumentId>& arg_map, const ShortOptionTable& short_options);
 
     //Returns true if str is in choices, or choices is empty
-    bool is_valid_choice(std::string str, const std::vector<std::string>& choices);
+    bool is_valid_choice(const std::string& str, const std::vector<std::string>& choices);
 
     //Returns 'str' interpreted as type T
     // Throws an exception if conversion fails
@@ -34,6 +57,11 @@ namespace argparse {
     template<typename Container>
     std::string join(Container container, std::string join_str);
 
+    //Calls func(begin, end, index) for each field of str separated by delimiter, stopping
+    //early if func returns false. Returns true if func accepted every field
+    template<typename Func>
+    bool for_each_field(const std::string& str, char delimiter, Func func);
+
     char* strdup(const char* str);
 
     std::vector<std::string> wrap_width(std::string str, size_t width, std::vector<std::string> split_str={" ", "/"});
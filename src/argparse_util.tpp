@@ -1,3 +1,4 @@
+#include <cstring>
 #include <sstream>
 #include "argparse.hpp"
 
@@ -31,4 +32,22 @@ namespace argparse {
 
         return ss.str();
     }
+
+    template<typename Func>
+    bool for_each_field(const std::string& str, char delimiter, Func func) {
+        const char* begin = str.data();
+        const char* end = str.data() + str.size();
+        for (size_t index = 0; ; ++index) {
+            //memchr() is vectorized by the C library, so long lists are scanned quickly
+            const char* field_end = static_cast<const char*>(std::memchr(begin, delimiter, size_t(end - begin)));
+            if (!field_end) {
+                field_end = end;
+            }
+
+            if (!func(begin, field_end, index)) return false;
+
+            if (field_end == end) return true;
+            begin = field_end + 1;
+        }
+    }
 }
@@ -1,10 +1,24 @@
 #ifndef ARGPARSE_VALUE_HPP
 #define ARGPARSE_VALUE_HPP
+#include <cstdint>
 #include <iostream>
+#include <string>
 #include "argparse_error.hpp"
 
 namespace argparse {
 
+    //Identifies an argument within its ArgumentParser
+    typedef uint16_t ArgumentId;
+
+    //ArgumentId of a value which has not been set by any argument
+    constexpr ArgumentId NO_ARGUMENT_ID = UINT16_MAX;
+
+    //Returns a reference to a (static) empty string
+    inline const std::string& empty_string() {
+        static const std::string empty;
+        return empty;
+    }
+
     template<class T>
     class ConvertedValue {
         public:
@@ -25,7 +39,7 @@ namespace argparse {
     };
 
     //How the value associated with an argumetn was initialized
-    enum class Provenance {
+    enum class Provenance : uint8_t {
         UNSPECIFIED,//The value was default constructed
         DEFAULT,    //The value was set by a default (e.g. as a command-line argument default value)
         SPECIFIED,  //The value was explicitly specified (e.g. explicitly specified on the command-line)
@@ -38,7 +52,9 @@ namespace argparse {
      * It supports implicit conversion to the underlying value_type, which means it can
      * be seamlessly used as the value_type in most situations.
      *
-     * It additionally tracks the provenance off the option, along with it's associated argument group.
+     * It additionally tracks the provenance off the option, along with the ID of the argument
+     * which set it. To keep option structs compact only the ID is stored: the argument's name and
+     * group are looked up through the parser (see ArgumentParser::argument_name()/argument_group()).
      */
     template<typename T>
     class ArgValue {
@@ -55,10 +71,8 @@ namespace argparse {
             //Returns the provenance of this argument (i.e. how it was initialized)
             Provenance provenance() const { return provenance_; }
 
-            //Returns the group this argument is associated with (or an empty string if none)
-            const std::string& argument_group() const { return argument_group_; }
-
-            const std::string& argument_name() const { return argument_name_; }
+            //Returns the ID of the argument which set this value (or NO_ARGUMENT_ID if none)
+            ArgumentId argument_id() const { return argument_id_; }
 
         public: //Mutators
             void set(ConvertedValue<T> val, Provenance prov) {
@@ -81,18 +95,14 @@ namespace argparse {
                 return value_;
             }
 
-            void set_argument_group(std::string grp) {
-                argument_group_ = grp;
-            }
-
-            void set_argument_name(std::string name_str) {
-                argument_name_ = name_str;
+            //Sets the ID of the argument associated with this value
+            void set_argument_id(ArgumentId id) {
+                argument_id_ = id;
             }
         private:
             T value_ = T();
             Provenance provenance_ = Provenance::UNSPECIFIED;
-            std::string argument_group_ = "";
-            std::string argument_name_ = "";
+            ArgumentId argument_id_ = NO_ARGUMENT_ID;
     };
 
     //Automatically convert to the underlying type for ostream output
@@ -0,0 +1,8 @@
+#include "argparse.hpp"
+
+namespace argparse {
+
+    //std::vector<bool> is not supported as a multi value
+    ARGPARSE_SINGLE_VALUE_INSTANTIATIONS(, bool)
+
+} //namespace
@@ -0,0 +1,10 @@
+#include "argparse.hpp"
+
+namespace argparse {
+
+    #define ARGPARSE_INSTANTIATE_DEFAULT_CONVERTER(T) template class DefaultConverter<T>;
+    ARGPARSE_NUMERIC_TYPES(ARGPARSE_INSTANTIATE_DEFAULT_CONVERTER)
+    ARGPARSE_CHARACTER_TYPES(ARGPARSE_INSTANTIATE_DEFAULT_CONVERTER)
+    #undef ARGPARSE_INSTANTIATE_DEFAULT_CONVERTER
+
+} //namespace
@@ -0,0 +1,7 @@
+#include "argparse.hpp"
+
+namespace argparse {
+
+    ARGPARSE_MULTI_VALUE_INSTANTIATIONS(, int)
+
+} //namespace
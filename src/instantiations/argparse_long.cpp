@@ -0,0 +1,7 @@
+#include "argparse.hpp"
+
+namespace argparse {
+
+    ARGPARSE_SINGLE_VALUE_INSTANTIATIONS(, long)
+
+} //namespace